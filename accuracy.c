@@ -0,0 +1,216 @@
+// 빌드: gcc -O2 -std=c11 accuracy.c -o accuracy -lm -lpthread
+// 실행: ./accuracy [-n 위치 수] [-j 시드 흔들기(픽셀)] [-t 스레드]
+// 합성 타깃에서 polynomial_fit 의 서브픽셀 RMS 오차와 실행 시간을 설정별로 출력
+#define CALIB_NO_MAIN
+#include "final.c"
+#include "synth.c"
+
+#include <time.h>
+
+#define ACC_WIDTH 640
+#define ACC_HEIGHT 480
+#define ACC_MATCH_DIST 1.5  // 이보다 먼 결과는 다른 코너로 수렴한 것으로 봄
+
+// 설정 하나의 누적 결과
+typedef struct {
+    int seeds;      // 넣은 시드 수
+    int kept;       // 수렴해 남은 코너 수
+    int outliers;   // 정답에서 ACC_MATCH_DIST 보다 먼 코너 수
+    double sq_err;  // 정답과 맞은 코너의 오차 제곱 합
+    double max_err;
+    double ns;      // 피팅 시간 합
+} acc_result;
+
+// ✅ 단조 시계 (나노초)
+static double now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// ✅ 결과 코너마다 가장 가까운 정답과의 거리로 오차 누적
+static void acc_score(const Corner2 *found, const Corner2 *truth, acc_result *res) {
+    for (int i = 0; i < found->Size; i++) {
+        double best = HUGE_VAL;
+        for (int t = 0; t < truth->Size; t++) {
+            double dx = found->p[i].x - truth->p[t].x, dy = found->p[i].y - truth->p[t].y;
+            double d = dx * dx + dy * dy;
+            if (d < best) {
+                best = d;
+            }
+        }
+        if (best > ACC_MATCH_DIST * ACC_MATCH_DIST) {
+            res->outliers++;
+            continue;
+        }
+        res->sq_err += best;
+        if (sqrt(best) > res->max_err) {
+            res->max_err = sqrt(best);
+        }
+    }
+    res->kept += found->Size;
+}
+
+// ✅ 설정 하나를 위치 positions 번 바꿔 가며 측정 (기준 코너를 매번 다른 소수 위치로)
+static int acc_run(synth_config cfg, const Params *params, int positions, double jitter, acc_result *res) {
+    image_view img;
+    Corner2 truth, work;
+    unsigned state = 12345;
+    memset(res, 0, sizeof(*res));
+    if (image_create(&img, ACC_WIDTH, ACC_HEIGHT) != 0) {
+        return -1;
+    }
+    corners_init(&truth);
+    corners_init(&work);
+
+    for (int k = 0; k < positions; k++) {
+        cfg.x0 = ACC_WIDTH / 2 + synth_rand(&state) / 4294967296.0;
+        cfg.y0 = ACC_HEIGHT / 2 + synth_rand(&state) / 4294967296.0;
+        cfg.seed = k + 1;
+        if (synth_render(&cfg, &img) != 0 ||
+            synth_ground_truth(&cfg, img.width, img.height, 2 * MAX_R + 2, &truth) < 0) {
+            break;
+        }
+
+        // 정답 주변 ±jitter 에서 시작
+        work.Size = 0;
+        for (int t = 0; t < truth.Size; t++) {
+            point2d p = truth.p[t];
+            p.x += jitter * (2 * (synth_rand(&state) / 4294967296.0) - 1);
+            p.y += jitter * (2 * (synth_rand(&state) / 4294967296.0) - 1);
+            corners_push(&work, p, R);
+        }
+        res->seeds += work.Size;
+
+        double t0 = now_ns();
+        polynomial_fit(&img, &work, params);
+        res->ns += now_ns() - t0;
+        acc_score(&work, &truth, res);
+    }
+
+    corners_free(&truth);
+    corners_free(&work);
+    image_destroy(&img);
+    return 0;
+}
+
+// ✅ 결과 한 줄
+static void acc_report(const char *pattern, const synth_config *cfg, const char *mode, const acc_result *res,
+                       int positions) {
+    int matched = res->kept - res->outliers;
+    printf("%-8s %5.2f %5.2f %5.1f %-9s %5d/%-5d %4d %9.4f %8.4f %9.2f %9.0f\n",
+           pattern, cfg->angle, cfg->blur_sigma, cfg->noise_sigma, mode,
+           res->kept, res->seeds, res->outliers,
+           matched > 0 ? sqrt(res->sq_err / matched) : 0.0, res->max_err,
+           res->ns / positions / 1e6, res->kept > 0 ? res->ns / res->kept : 0.0);
+}
+
+// ✅ 왼쪽 가장자리 가까이 둔 코너 하나를 정답 위치에서 시작해 피팅, 가장자리 거리별로 결과 한 줄씩
+// 블러 테두리 (0 으로 채운 r 픽셀) 에 패치가 닿는 시드는 기각돼야 하고, 남은 코너는 오차가 작아야 함
+static int acc_border(const Params *params) {
+    image_view img;
+    Corner2 work;
+    if (image_create(&img, ACC_WIDTH, ACC_HEIGHT) != 0) {
+        return -1;
+    }
+    corners_init(&work);
+
+    printf("\n%-8s %7s %6s %9s\n", "border", "x0", "kept", "err px");
+    for (double x0 = 3.3; x0 < 4 * R + 1; x0 += 1.0) {
+        synth_config cfg;
+        synth_config_default(&cfg);
+        cfg.x0 = x0;
+        cfg.y0 = ACC_HEIGHT / 2 + 0.49;
+        cfg.quantize = 1;
+        if (synth_render(&cfg, &img) != 0) {
+            break;
+        }
+        work.Size = 0;
+        corners_push(&work, (point2d){cfg.x0, cfg.y0}, R);
+        polynomial_fit(&img, &work, params);
+        double err = 0.0;
+        if (work.Size > 0) {
+            err = hypot(work.p[0].x - cfg.x0, work.p[0].y - cfg.y0);
+        }
+        printf("%-8s %7.2f %6d %9.4f\n", "checker", x0, work.Size, err);
+    }
+
+    corners_free(&work);
+    image_destroy(&img);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int positions = 4, threads = 1;
+    double jitter = 1.0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-n") == 0) {
+            positions = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "-j") == 0) {
+            jitter = atof(argv[i + 1]);
+        } else if (strcmp(argv[i], "-t") == 0) {
+            threads = atoi(argv[i + 1]);
+        }
+    }
+    if (positions < 1) {
+        positions = 1;
+    }
+
+    static const double angles[] = {0.0, 0.3};
+    static const double blurs[] = {0.0, 1.0};
+    static const double noises[] = {0.0, 4.0};
+    static const struct { blur_mode mode; int phase_lut; double recenter_max; int cascade; const char *name; } modes[] = {
+        {BLUR_EXACT, 0, 0.0, 0, "exact"}, {BLUR_SEPARABLE, 0, 0.0, 0, "separable"},
+        {BLUR_SIMD_F32, 0, 0.0, 0, "simd_f32"}, {BLUR_LAZY, 0, 0.0, 0, "lazy"},
+        {BLUR_EXACT, 1, 0.0, 0, "phase_lut"}, {BLUR_EXACT, 0, 0.5, 0, "recenter"}, {BLUR_EXACT, 0, 0.0, 1, "cascade"},
+    };
+
+    Params params;
+    params_default(&params);
+    params.pool = (threads != 1) ? thread_pool_create(threads) : NULL;
+
+    printf("%-8s %5s %5s %5s %-9s %11s %4s %9s %8s %9s %9s\n", "pattern", "angle", "blur", "noise", "mode",
+           "kept/seeds", "out", "rms px", "max px", "ms/frame", "ns/corner");
+    for (int p = 0; p < 2; p++) {
+        synth_config cfg;
+        synth_config_default(&cfg);
+        cfg.pattern = p ? SYNTH_DELTILLE : SYNTH_CHECKERBOARD;
+        cfg.quantize = 1;
+        params.corner_type = p ? CORNER_MONKEY_SADDLE : CORNER_SADDLE;
+        params.max_iteration = p ? 10 : 5;
+
+        for (int a = 0; a < 2; a++) {
+            for (int b = 0; b < 2; b++) {
+                for (int n = 0; n < 2; n++) {
+                    cfg.angle = angles[a];
+                    cfg.blur_sigma = blurs[b];
+                    cfg.noise_sigma = noises[n];
+                    for (int m = 0; m < (int)(sizeof(modes) / sizeof(modes[0])); m++) {
+                        acc_result res;
+                        params.blur = modes[m].mode;
+                        params.phase_lut = modes[m].phase_lut;
+                        params.recenter_max = modes[m].recenter_max;
+                        params.cascade = modes[m].cascade;
+                        if (acc_run(cfg, &params, positions, jitter, &res) != 0) {
+                            return 1;
+                        }
+                        acc_report(p ? "deltille" : "checker", &cfg, modes[m].name, &res, positions);
+                    }
+                }
+            }
+        }
+    }
+
+    params.blur = BLUR_EXACT;
+    params.phase_lut = 0;
+    params.recenter_max = 0.0;
+    params.cascade = 0;
+    params.corner_type = CORNER_SADDLE;
+    params.max_iteration = 5;
+    if (acc_border(&params) != 0) {
+        return 1;
+    }
+
+    thread_pool_destroy(params.pool);
+    return 0;
+}
@@ -0,0 +1,415 @@
+// 빌드: gcc -O2 -std=c11 bench.c -o bench -lm -lpthread
+// 실행: ./bench [-n 반복] [-t 스레드] [이미지.pgm ...]
+// calibration_images 의 jpg 는 PGM(P5) 으로 변환해서 넘김 (예: convert left01.jpg left01.pgm)
+#define CALIB_NO_MAIN
+#include "final.c"
+#include "synth.c"
+
+#include <time.h>
+
+#define BENCH_WARMUP 2
+#define BENCH_REPS 10
+#define BENCH_FRAMES 8  // 프레임 스트림 측정의 프레임 수
+
+// 측정 대상 함수 (ctx 는 준비된 입력, 한 번 호출이 한 측정 단위)
+typedef void (*bench_fn)(void *ctx);
+
+// ✅ 단조 시계 (나노초)
+static double now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// ✅ 워밍업 후 reps 번 측정, 중앙값(ns) 반환 (min_ns 가 있으면 최솟값도 기록)
+static double bench_run(bench_fn fn, void *ctx, int reps, double *min_ns) {
+    double samples[256];
+    if (reps > 256) {
+        reps = 256;
+    }
+    for (int i = 0; i < BENCH_WARMUP; i++) {
+        fn(ctx);
+    }
+    for (int i = 0; i < reps; i++) {
+        double t0 = now_ns();
+        fn(ctx);
+        samples[i] = now_ns() - t0;
+    }
+    qsort(samples, reps, sizeof(double), compare_double);
+    if (min_ns != NULL) {
+        *min_ns = samples[0];
+    }
+    return samples[reps / 2];
+}
+
+// ✅ 결과 한 줄: 호출당 시간과 단위(픽셀/코너)당 시간
+static void bench_report(const char *name, const char *input, double median, double min, double units, const char *unit) {
+    printf("%-28s %-16s %12.0f %12.0f", name, input, median, min);
+    if (units > 0) {
+        printf(" %12.2f ns/%s", median / units, unit);
+    }
+    printf("\n");
+}
+
+// ✅ 분리형 블러 결과 한 줄: 시간 + 사용한 랭크, 오차 한계 (잔차 L1 합 x max|입력|), 직접 컨볼루션 대비 실제 최대 오차
+static void bench_report_separable(const image_view *img, const double *kernel, double tol, const char *name,
+                                   double median, double min) {
+    image_view sep, exact;
+    image_source src = image_source_view(img);
+    double residual = 0.0, max_in = 0.0, max_err = 0.0;
+    if (image_create(&sep, img->width, img->height) != 0) {
+        return;
+    }
+    if (image_create(&exact, img->width, img->height) != 0) {
+        image_destroy(&sep);
+        return;
+    }
+    int rank = apply_convolution_separable(&src, R, tol, &sep, &residual);
+    apply_convolution(img, kernel, R, &exact);
+    for (int y = 0; y < img->height; y++) {
+        for (int x = 0; x < img->width; x++) {
+            double in = fabs(PIXEL(img, x, y)), err = fabs(PIXEL(&sep, x, y) - PIXEL(&exact, x, y));
+            max_in = (in > max_in) ? in : max_in;
+            max_err = (err > max_err) ? err : max_err;
+        }
+    }
+    printf("%-28s %-16s %12.0f %12.0f %12.2f ns/pixel  rank %d bound %.4f max err %.4f\n",
+           "apply_blur separable", name, median, min, median / ((double)img->width * img->height),
+           rank, residual * max_in, max_err);
+    image_destroy(&sep);
+    image_destroy(&exact);
+}
+
+// ✅ 합성 보드의 안쪽 코너를 count 개 시드로 (±1 픽셀 흔들기, 부족하면 반복, 정답 코너 수 반환)
+static int board_seeds(const image_view *img, const synth_config *board, int count, Corner2 *seeds) {
+    Corner2 truth;
+    corners_init(&truth);
+    int n = synth_ground_truth(board, img->width, img->height, 2 * MAX_R + 2, &truth);
+    seeds->Size = 0;
+    for (int k = 0; k < count && n > 0; k++) {
+        point2d p = truth.p[k % n];
+        p.x += (rand() % 201 - 100) / 100.0;
+        p.y += (rand() % 201 - 100) / 100.0;
+        if (corners_push(seeds, p, R) < 0) {
+            n = -1;
+        }
+    }
+    corners_free(&truth);
+    return n;
+}
+
+// 벤치 입력 묶음
+typedef struct {
+    const image_view *img;
+    image_view out;
+    const fit_operator *op;
+    Corner2 seeds;
+    Corner2 work;
+    refine_state st;
+    Params params;
+    point2d pts[1024];
+    double patch[MAX_PATCH_SIZE];
+    double A[MAX_PATCH_SIZE * MAX_TERMS];
+    double invAtAAt[MAX_PATCH_SIZE * MAX_TERMS];
+    double M[MATRIX_SIZE][MATRIX_SIZE];
+    double M_inv[MATRIX_SIZE][MATRIX_SIZE];
+    double kernel[MAX_PATCH_SIZE];
+    int rows;
+} bench_ctx;
+
+static void run_cone_kernel(void *p) {
+    bench_ctx *b = p;
+    create_cone_filter_kernel(b->kernel, R);
+}
+
+static void run_convolution(void *p) {
+    bench_ctx *b = p;
+    apply_convolution(b->img, b->op->mask, R, &b->out);
+}
+
+static void run_blur(void *p) {
+    bench_ctx *b = p;
+    image_source src = image_source_view(b->img);
+    apply_blur(&src, b->op->mask, R, &b->params, &b->out);
+}
+
+static void run_patches(void *p) {
+    bench_ctx *b = p;
+    int n;
+    for (int i = 0; i < 1024; i++) {
+        get_image_patch_with_mask(b->img, b->op->mask, b->pts[i].x, b->pts[i].y, R, b->patch, &n);
+    }
+}
+
+static void run_inverse(void *p) {
+    bench_ctx *b = p;
+    inverse_matrix_6x6(b->M, b->M_inv);
+}
+
+static void run_invAtAAt(void *p) {
+    bench_ctx *b = p;
+    compute_invAtAAt(b->A, b->rows, MATRIX_SIZE, b->invAtAAt);
+}
+
+// 코너 목록은 매 호출 시드로 되돌림 (피팅이 수렴 못한 코너를 지우므로)
+static void reset_work(bench_ctx *b) {
+    b->work.Size = 0;
+    for (int i = 0; i < b->seeds.Size; i++) {
+        corners_push(&b->work, b->seeds.p[i], b->seeds.r[i]);
+    }
+}
+
+static void run_fit(void *p) {
+    bench_ctx *b = p;
+    reset_work(b);
+    polynomial_fit_saddle(b->img, &b->work, &b->params);
+}
+
+static void run_newton(void *p) {
+    bench_ctx *b = p;
+    memcpy(b->st.pos, b->seeds.p, b->seeds.Size * sizeof(point2d));
+    memset(b->st.iterations, 0, b->seeds.Size * sizeof(int));
+    memset(b->st.unconfirmed, 0, b->seeds.Size * sizeof(int));
+    memset(b->st.status, REFINE_ACTIVE, b->seeds.Size);
+    refine_corners_newton(&b->out, b->op, &b->st, &b->params);
+}
+
+static void run_find(void *p) {
+    bench_ctx *b = p;
+    find_corners(b->img, &b->work, &b->params);
+}
+
+static void run_find_dense(void *p) {
+    bench_ctx *b = p;
+    image_source src = image_source_view(b->img);
+    find_corners_dense(&src, &b->work, &b->params);
+}
+
+// 프레임 스트림 입력: 메모리에 렌더해 둔 프레임 (디스크 읽기 없이 단계 겹침만 측정)
+typedef struct {
+    image_view frames[BENCH_FRAMES];
+    int num_frames;
+    Params params;
+} bench_stream;
+
+static int stream_load(void *ctx, int index, pipeline_frame *frame) {
+    const bench_stream *s = ctx;
+    frame->src = image_source_view(&s->frames[index % s->num_frames]);
+    return 0;
+}
+
+static void run_stream_sequential(void *p) {
+    bench_stream *s = p;
+    Corner2 corners;
+    corners_init(&corners);
+    for (int i = 0; i < s->num_frames; i++) {
+        image_source src = image_source_view(&s->frames[i]);
+        find_corners_source(&src, &corners, &s->params);
+    }
+    corners_free(&corners);
+}
+
+static void run_stream_pipeline(void *p) {
+    bench_stream *s = p;
+    pipeline_config cfg = {s->num_frames, 0, stream_load, s, NULL, NULL};
+    run_frame_pipeline(&cfg, &s->params);
+}
+
+// ✅ 프레임 스트림: 한 장씩 find_corners 를 부르는 경우와 run_frame_pipeline 비교 (프레임당 시간)
+// 순차 쪽은 -t 풀을 그대로 쓰고, 파이프라인은 풀 없이 단계마다 스레드 하나 (run_frame_pipeline 참고)
+static void bench_stream_frames(const Params *params, int W, int H, int reps) {
+    static bench_stream s;
+    char name[32];
+    double med, min;
+    s.params = *params;
+    s.num_frames = 0;
+    for (int i = 0; i < BENCH_FRAMES; i++) {
+        synth_config board;
+        synth_config_default(&board);
+        board.x0 = W / 2 + 3.1 * i + 0.37;
+        board.y0 = H / 2 - 1.7 * i + 0.21;
+        board.size = W / 16.0;
+        board.angle = 0.3 + 0.02 * i;
+        board.supersample = 4;
+        board.noise_sigma = 2.0;
+        board.seed = i + 1;
+        if (image_create(&s.frames[i], W, H) != 0 || synth_render(&board, &s.frames[i]) != 0) {
+            break;
+        }
+        s.num_frames++;
+    }
+
+    snprintf(name, sizeof(name), "%dx%d x%d", W, H, s.num_frames);
+    med = bench_run(run_stream_sequential, &s, reps, &min);
+    bench_report("frames find_corners", name, med, min, s.num_frames, "frame");
+    med = bench_run(run_stream_pipeline, &s, reps, &min);
+    bench_report("frames run_frame_pipeline", name, med, min, s.num_frames, "frame");
+
+    for (int i = 0; i < s.num_frames; i++) {
+        image_destroy(&s.frames[i]);
+    }
+}
+
+// ✅ 크기와 상관없는 커널: 원뿔 커널, 6x6 역행렬, (AᵀA)⁻¹Aᵀ, 패치 추출
+static void bench_small_kernels(bench_ctx *b, int reps) {
+    double med, min;
+
+    med = bench_run(run_cone_kernel, b, reps, &min);
+    bench_report("create_cone_filter_kernel", "r=4", med, min, 0, NULL);
+
+    double row[MAX_TERMS];
+    b->rows = 0;
+    for (int j = -R; j <= R; j++) {
+        for (int i = -R; i <= R; i++) {
+            if (b->op->mask[(j + R) * (2 * R + 1) + i + R] >= 1e-6) {
+                design_row(2, i, j, row);
+                memcpy(b->A + (size_t)b->rows * MATRIX_SIZE, row, sizeof(double) * MATRIX_SIZE);
+                b->rows++;
+            }
+        }
+    }
+    double At[MATRIX_SIZE * MAX_PATCH_SIZE];
+    transpose_matrix(b->A, b->rows, MATRIX_SIZE, At);
+    multiply_matrices(At, b->A, &b->M[0][0], MATRIX_SIZE, b->rows, MATRIX_SIZE);
+
+    med = bench_run(run_inverse, b, reps * 100, &min);
+    bench_report("inverse_matrix_6x6", "AtA r=4", med, min, 0, NULL);
+    med = bench_run(run_invAtAAt, b, reps * 10, &min);
+    bench_report("compute_invAtAAt", "r=4", med, min, 0, NULL);
+
+    med = bench_run(run_patches, b, reps, &min);
+    bench_report("get_image_patch_with_mask", "1024 pts", med, min, 1024, "corner");
+}
+
+// ✅ 한 이미지에서 블러/피팅/전체 검출 측정 (board 가 있으면 코너 수를 바꿔 가며 피팅)
+static void bench_image(bench_ctx *b, const image_view *img, const char *name, int reps,
+                        const synth_config *board) {
+    char label[64];
+    double med, min;
+    double pixels = (double)img->width * img->height;
+
+    b->img = img;
+    if (image_create(&b->out, img->width, img->height) != 0) {
+        return;
+    }
+
+    med = bench_run(run_convolution, b, reps, &min);
+    bench_report("apply_convolution", name, med, min, pixels, "pixel");
+    b->params.blur = BLUR_SEPARABLE;
+    med = bench_run(run_blur, b, reps, &min);
+    bench_report_separable(img, b->op->mask, b->params.blur_tol, name, med, min);
+    b->params.blur = BLUR_SIMD_F32;
+    med = bench_run(run_blur, b, reps, &min);
+    bench_report("apply_blur simd_f32", name, med, min, pixels, "pixel");
+    b->params.blur = BLUR_EXACT;
+
+    if (board != NULL) {
+        static const int counts[] = {16, 256, 4096};
+        apply_convolution(img, b->op->mask, R, &b->out);
+        for (int c = 0; c < 3; c++) {
+            srand(1);
+            if (board_seeds(img, board, counts[c], &b->seeds) <= 0) {
+                continue;
+            }
+            snprintf(label, sizeof(label), "%s %d", name, counts[c]);
+            med = bench_run(run_fit, b, reps, &min);
+            bench_report("polynomial_fit_saddle", label, med, min, b->seeds.Size, "corner");
+            b->params.blur = BLUR_LAZY;
+            med = bench_run(run_fit, b, reps, &min);
+            bench_report("  lazy blur", label, med, min, b->seeds.Size, "corner");
+            b->params.blur = BLUR_EXACT;
+            if (refine_state_init(&b->st, &b->seeds) == 0) {
+                med = bench_run(run_newton, b, reps, &min);
+                bench_report("  newton only (pre-blurred)", label, med, min, b->seeds.Size, "corner");
+                refine_state_free(&b->st);
+            }
+        }
+    }
+
+    med = bench_run(run_find, b, reps, &min);
+    bench_report("find_corners", name, med, min, pixels, "pixel");
+    med = bench_run(run_find_dense, b, reps, &min);
+    bench_report("find_corners_dense", name, med, min, pixels, "pixel");
+    image_destroy(&b->out);
+}
+
+int main(int argc, char **argv) {
+    static bench_ctx b;
+    int reps = BENCH_REPS, threads = 1;
+    int argi = 1;
+    for (; argi + 1 < argc && argv[argi][0] == '-'; argi += 2) {
+        if (strcmp(argv[argi], "-n") == 0) {
+            reps = atoi(argv[argi + 1]);
+        } else if (strcmp(argv[argi], "-t") == 0) {
+            threads = atoi(argv[argi + 1]);
+        }
+    }
+    if (reps < 1) {
+        reps = 1;
+    }
+
+    params_default(&b.params);
+    b.params.pool = (threads != 1) ? thread_pool_create(threads) : NULL;
+    b.op = get_fit_operator(R, 2);
+    corners_init(&b.seeds);
+    corners_init(&b.work);
+    if (b.op == NULL) {
+        return 1;
+    }
+
+    printf("%-28s %-16s %12s %12s\n", "kernel", "input", "median ns", "min ns");
+
+    // 합성 체커보드 (크기별로 칸 크기를 바꿔 코너 수가 비슷하지 않게 함)
+    static const int sizes[3][2] = {{100, 100}, {640, 480}, {1920, 1080}};
+    for (int s = 0; s < 3; s++) {
+        image_view img;
+        int W = sizes[s][0], H = sizes[s][1];
+        synth_config board;
+        char name[32];
+        synth_config_default(&board);
+        board.x0 = W / 2 + 0.37;
+        board.y0 = H / 2 + 0.21;
+        board.size = W < 200 ? 12 : W / 16.0;
+        board.angle = 0.3;
+        board.supersample = 4;
+        if (image_create(&img, W, H) != 0 || synth_render(&board, &img) != 0) {
+            return 1;
+        }
+        if (s == 0) {
+            srand(1);
+            for (int i = 0; i < 1024; i++) {
+                b.pts[i].x = R + 1 + rand() % (W - 2 * R - 3) + rand() / (RAND_MAX + 1.0);
+                b.pts[i].y = R + 1 + rand() % (H - 2 * R - 3) + rand() / (RAND_MAX + 1.0);
+            }
+            b.img = &img;
+            bench_small_kernels(&b, reps);
+        }
+        snprintf(name, sizeof(name), "%dx%d", W, H);
+        bench_image(&b, &img, name, reps, &board);
+        image_destroy(&img);
+    }
+
+    bench_stream_frames(&b.params, 1920, 1080, reps);
+
+    // 실제 캘리브레이션 이미지 (PGM)
+    for (; argi < argc; argi++) {
+        image_view img;
+        if (image_load_pgm(argv[argi], &img) != 0) {
+            fprintf(stderr, "cannot load image: %s\n", argv[argi]);
+            continue;
+        }
+        const char *base = strrchr(argv[argi], '/');
+        bench_image(&b, &img, base ? base + 1 : argv[argi], reps, NULL);
+        image_destroy(&img);
+    }
+
+    corners_free(&b.seeds);
+    corners_free(&b.work);
+    thread_pool_destroy(b.params.pool);
+    return 0;
+}
@@ -1,100 +1,953 @@
+// 빌드: gcc -O2 -std=c11 final.c -o final -lm -lpthread
+// 계측 빌드: gcc -O2 -std=c11 -DCALIB_STATS final.c -o final -lm -lpthread (fit_stats 에 단계별 시간/탈락 사유 기록)
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CALIB_X86 1
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
-#define WIDTH 100
-#define HEIGHT 100
 #define R 4  
-#define KERNEL_SIZE (2 * R + 1)
-#define MATRIX_SIZE 6
-#define PATCH_SIZE (KERNEL_SIZE * KERNEL_SIZE)
-#define MAX_CORNERS (WIDTH * HEIGHT)
+#define MAX_R 10
+#define MAX_KERNEL_SIZE (2 * MAX_R + 1)
+#define MAX_PATCH_SIZE (MAX_KERNEL_SIZE * MAX_KERNEL_SIZE)
+#define MATRIX_SIZE 6          // 2차 피팅 항 수
+#define MONKEY_MATRIX_SIZE 10  // 3차(monkey saddle) 피팅 항 수
+#define MAX_TERMS MONKEY_MATRIX_SIZE
+#define FIT_BATCH 32      // 한 번에 계수를 구하는 코너 수
+#define REFINE_CHUNK 64   // 스레드 풀에서 한 번에 가져가는 코너 수
+#define IMAGE_ALIGN 64  // 캐시 라인 정렬 (바이트)
+#define CONV_TILE 256   // 8/16비트 원본 블러의 열 타일 폭 (변환 링 버퍼 크기)
+#define LAZY_TILE 32    // 지연 블러 타일 한 변 (픽셀)
+#define PHASE_STEPS 32  // 위상 표 서브픽셀 단계 (1/32 픽셀)
 
 // 2D 점 구조체
 typedef struct {
     double x, y;
 } point2d;
 
-// 코너 구조체
+// 이미지 뷰 구조체 (해상도는 실행 시간에 결정)
+typedef struct {
+    double *data;
+    int width;
+    int height;
+    int stride;  // 한 행의 원소 수 (width 이상, IMAGE_ALIGN 배수로 맞춤)
+} image_view;
+
+// float32 이미지 뷰 (블러 SIMD 경로용)
+typedef struct {
+    float *data;
+    int width;
+    int height;
+    int stride;
+} image_view_f32;
+
+// 원본 픽셀 형식
+typedef enum {
+    PIXEL_F64,  // double
+    PIXEL_U8,   // 8비트 그레이 (카메라 기본)
+    PIXEL_U16   // 16비트 그레이 (호스트 바이트 순서)
+} pixel_format;
+
+// 외부 버퍼를 복사 없이 가리키는 원본 이미지 (블러/패치 샘플링이 읽을 때 double 로 변환)
+typedef struct {
+    const void *data;
+    int width;
+    int height;
+    int stride;  // 한 행의 원소 수
+    pixel_format format;
+} image_source;
+
+// 블러 방식
+typedef enum {
+    BLUR_EXACT,      // 원뿔 커널 직접 컨볼루션
+    BLUR_SEPARABLE,  // 저랭크 분리형 근사 (행/열 1D 패스의 합)
+    BLUR_SIMD_F32,   // float32 변환 후 SIMD 컨볼루션
+    BLUR_LAZY        // 피팅 시 패치가 닿는 타일만 필요할 때 블러 (전체 블러가 필요한 곳은 BLUR_EXACT)
+} blur_mode;
+
+typedef struct thread_pool thread_pool;
+
+// 코너 종류
+typedef enum {
+    CORNER_SADDLE,        // 체커보드 (2차 피팅)
+    CORNER_MONKEY_SADDLE  // deltille (3차 피팅)
+} corner_type_t;
+
+// 검출/피팅 계측 (CALIB_STATS 로 빌드했을 때만 기록, 호출자가 프레임마다 fit_stats_reset)
+typedef struct {
+    double detect_ns;             // 후보 검출 (피라미드 포함)
+    double blur_ns;               // 검출/피팅용 블러
+    double newton_ns;             // 뉴턴 반복
+    double dedup_ns;              // 중복 코너 제거
+    long candidates;              // 피팅에 들어온 코너 수
+    long converged;
+    long rejected_border;         // 패치가 이미지 밖으로 나감
+    long rejected_det;            // 2차 det >= 0 (3차는 판별식 <= 0), 안장점 형태가 아님
+    long rejected_not_converged;  // max_iteration 안에 수렴 못함
+    long rejected_signs;          // 조기 기각 (둘레 부호 교대)
+    long iterations;              // 뉴턴 반복 횟수 합 (코너별, 패치 샘플링 횟수)
+    long resamples_saved;         // recenter_max 규칙으로 건너뛴 수렴 확인 샘플링 횟수
+    long duplicates;              // 중복으로 제거한 코너 수
+    long lazy_tiles;              // BLUR_LAZY 에서 계산한 블러 타일 수
+} fit_stats;
+
+// 검출 파라미터
+typedef struct {
+    corner_type_t corner_type;
+    blur_mode blur;
+    double blur_tol;    // 분리형 근사 허용 오차 (잔차 커널의 L1 합)
+    int max_iteration;  // 뉴턴 반복 최대 횟수
+    double eps;         // 수렴 판정 이동 거리 (픽셀)
+    thread_pool *pool;  // 블러/코너 정제용 스레드 풀 (NULL 이면 단일 스레드)
+    double detect_threshold;  // 후보 검출: 최대 안장 응답 대비 최소 비율
+    int nms_radius;           // 후보 검출: 비최대 억제 반경 (픽셀)
+    int pyramid_levels;       // 후보 검출 피라미드 단계 수 (0 이면 원본 해상도에서 검출)
+                              // 가장자리 띠는 원본에서 따로 검출, 가장 거친 단계에서 칸이 약 2R+2 픽셀보다 작으면 코너를 놓침
+    int phase_lut;            // 1 이면 위상 표 피팅 (패치 중심을 1/PHASE_STEPS 픽셀 격자에 맞춤)
+    int cascade;              // 1 이면 뉴턴 전에 둘레 16점 부호 교대로 조기 기각 (검출기 후보용, 먼 시드는 수렴할 것도 버림)
+    double recenter_max;      // 뉴턴 이동이 이 값 이하이고 같은 픽셀 칸이면 확인 샘플링 없이 수렴 처리 (0 이면 끔)
+    fit_stats *stats;         // 계측 누적 대상 (NULL 이거나 CALIB_STATS 가 없으면 기록 안 함)
+} Params;
+
+// 계측 매크로: CALIB_STATS 가 없으면 인자를 평가하지 않고 사라짐
+#ifdef CALIB_STATS
+#include <time.h>
+static inline double stats_now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+#define STATS_CLOCK(t) double t = stats_now_ns()
+#define STATS_ADD(params, field, v) \
+    do { if ((params) != NULL && (params)->stats != NULL) (params)->stats->field += (v); } while (0)
+#define STATS_ELAPSED(params, field, t) STATS_ADD(params, field, stats_now_ns() - (t))
+#else
+#define STATS_CLOCK(t) ((void)0)
+#define STATS_ADD(params, field, v) ((void)(params), (void)sizeof(v))
+#define STATS_ELAPSED(params, field, t) ((void)(params))
+#endif
+
+// 코너별 뉴턴 반복 결과
+enum {
+    REFINE_ACTIVE,          // 아직 반복 중
+    REFINE_CONVERGED,       // 이동 거리 <= eps
+    REFINE_OUT_OF_BOUNDS,   // 패치가 이미지 밖으로 나감
+    REFINE_NOT_SADDLE,      // 안장점(또는 monkey saddle) 형태가 아님
+    REFINE_NOT_CONVERGED,   // max_iteration 안에 수렴 못함
+    REFINE_CASCADE_SIGNS    // 조기 기각: 둘레 샘플의 부호 교대가 4번 미만 (모서리/평탄/얼룩)
+};
+
+// 코너별 뉴턴 반복 상태 (필드별 배열)
+typedef struct {
+    point2d *pos;            // 현재 위치
+    int *iterations;         // 수행한 반복 횟수 (패치를 샘플링한 횟수)
+    int *unconfirmed;        // 1 이면 recenter_max 규칙으로 확인 샘플링 없이 수렴 처리됨
+    double *residual;        // 마지막 갱신 크기 |(dx, dy)|
+    unsigned char *status;   // REFINE_*
+    int count;
+} refine_state;
+
+#define PIXEL(img, x, y) ((img)->data[(size_t)(y) * (img)->stride + (x)])
+
+// 코너 구조체 (필드별 배열, 크기는 필요에 따라 증가)
 typedef struct {
-    point2d p[MAX_CORNERS];
-    int r[MAX_CORNERS];
-    point2d v1[MAX_CORNERS];
-    point2d v2[MAX_CORNERS];
-    point2d v3[MAX_CORNERS];
-    double Score[MAX_CORNERS];
+    point2d *p;
+    int *r;
+    point2d *v1;
+    point2d *v2;
+    point2d *v3;
+    double *Score;
     int Size;
+    int Capacity;
 } Corner2;
 
-// ✅ 행렬-벡터 곱셈
-void multiply_matrix_vector(double A[MATRIX_SIZE][MATRIX_SIZE], double b[MATRIX_SIZE], double k[MATRIX_SIZE]) {
-    for (int i = 0; i < MATRIX_SIZE; i++) {
-        k[i] = 0;
-        for (int j = 0; j < MATRIX_SIZE; j++) {
-            k[i] += A[i][j] * b[j];
+// ✅ IMAGE_ALIGN 정렬 메모리 할당 (크기를 정렬 단위로 올림)
+static void *aligned_malloc(size_t bytes) {
+    bytes = (bytes + IMAGE_ALIGN - 1) / IMAGE_ALIGN * IMAGE_ALIGN;
+    return aligned_alloc(IMAGE_ALIGN, bytes ? bytes : IMAGE_ALIGN);
+}
+
+// ✅ 빈 코너 집합 초기화
+void corners_init(Corner2 *corners) {
+    memset(corners, 0, sizeof(*corners));
+}
+
+// ✅ 코너 집합 메모리 해제
+void corners_free(Corner2 *corners) {
+    free(corners->p);
+    free(corners->r);
+    free(corners->v1);
+    free(corners->v2);
+    free(corners->v3);
+    free(corners->Score);
+    corners_init(corners);
+}
+
+// ✅ 용량 확보 (기존 데이터 유지, 성공 시 0)
+int corners_reserve(Corner2 *corners, int capacity) {
+    if (capacity <= corners->Capacity) {
+        return 0;
+    }
+
+    Corner2 grown;
+    grown.p = aligned_malloc(capacity * sizeof(point2d));
+    grown.r = aligned_malloc(capacity * sizeof(int));
+    grown.v1 = aligned_malloc(capacity * sizeof(point2d));
+    grown.v2 = aligned_malloc(capacity * sizeof(point2d));
+    grown.v3 = aligned_malloc(capacity * sizeof(point2d));
+    grown.Score = aligned_malloc(capacity * sizeof(double));
+    grown.Size = corners->Size;
+    grown.Capacity = capacity;
+
+    if (!grown.p || !grown.r || !grown.v1 || !grown.v2 || !grown.v3 || !grown.Score) {
+        corners_free(&grown);
+        return -1;
+    }
+
+    int n = corners->Size;
+    if (n > 0) {
+        memcpy(grown.p, corners->p, n * sizeof(point2d));
+        memcpy(grown.r, corners->r, n * sizeof(int));
+        memcpy(grown.v1, corners->v1, n * sizeof(point2d));
+        memcpy(grown.v2, corners->v2, n * sizeof(point2d));
+        memcpy(grown.v3, corners->v3, n * sizeof(point2d));
+        memcpy(grown.Score, corners->Score, n * sizeof(double));
+    }
+    corners_free(corners);
+    *corners = grown;
+    return 0;
+}
+
+// ✅ 코너 추가 (추가된 인덱스, 실패 시 -1)
+int corners_push(Corner2 *corners, point2d p, int r) {
+    if (corners->Size == corners->Capacity &&
+        corners_reserve(corners, corners->Capacity ? corners->Capacity * 2 : 64) != 0) {
+        return -1;
+    }
+
+    int n = corners->Size++;
+    point2d zero = {0, 0};
+    corners->p[n] = p;
+    corners->r[n] = r;
+    corners->v1[n] = zero;
+    corners->v2[n] = zero;
+    corners->v3[n] = zero;
+    corners->Score[n] = 0;
+    return n;
+}
+
+// ✅ keep[i] != 0 인 코너만 순서를 유지한 채 앞으로 모음 (제자리, 할당 없음)
+void corners_compact(Corner2 *corners, const unsigned char *keep) {
+    int n = 0;
+    for (int i = 0; i < corners->Size; i++) {
+        if (!keep[i]) {
+            continue;
+        }
+        if (n != i) {
+            corners->p[n] = corners->p[i];
+            corners->r[n] = corners->r[i];
+            corners->v1[n] = corners->v1[i];
+            corners->v2[n] = corners->v2[i];
+            corners->v3[n] = corners->v3[i];
+            corners->Score[n] = corners->Score[i];
+        }
+        n++;
+    }
+    corners->Size = n;
+}
+
+// 워커별 작업 범위 [next, end) (캐시 라인 단위로 분리)
+typedef struct {
+    atomic_int next;
+    int end;
+    char pad[IMAGE_ALIGN - sizeof(atomic_int) - sizeof(int)];
+} work_range;
+
+// 병렬 작업 함수: 인덱스 [begin, end) 처리
+typedef void (*parallel_fn)(void *ctx, int begin, int end);
+
+typedef struct {
+    thread_pool *pool;
+    int index;
+} pool_worker;
+
+// 스레드 풀 (호출 스레드가 0번 워커로 함께 일함)
+struct thread_pool {
+    int num_threads;
+    pthread_t *threads;
+    pool_worker *workers;
+    work_range *ranges;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    unsigned generation;  // 새 작업마다 증가
+    int running;          // 현재 작업 중인 백그라운드 워커 수
+    int shutdown;
+    parallel_fn fn;
+    void *ctx;
+    int chunk;
+};
+
+// ✅ 자기 범위를 chunk 단위로 처리한 뒤 다른 워커의 범위에서 훔쳐 옴
+static void pool_work(thread_pool *pool, int self) {
+    for (int v = 0; v < pool->num_threads; v++) {
+        work_range *range = &pool->ranges[(self + v) % pool->num_threads];
+        for (;;) {
+            int begin = atomic_fetch_add(&range->next, pool->chunk);
+            if (begin >= range->end) {
+                break;
+            }
+            int end = (begin + pool->chunk < range->end) ? begin + pool->chunk : range->end;
+            pool->fn(pool->ctx, begin, end);
+        }
+    }
+}
+
+// ✅ 백그라운드 워커 루프
+static void *pool_thread_main(void *arg) {
+    pool_worker *worker = arg;
+    thread_pool *pool = worker->pool;
+    unsigned seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        pool_work(pool, worker->index);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0) {
+            pthread_cond_signal(&pool->done);
         }
     }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+// ✅ 스레드 풀 생성 (num_threads <= 0 이면 온라인 CPU 수, 실패 시 NULL)
+thread_pool *thread_pool_create(int num_threads) {
+    if (num_threads <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = (n > 0) ? (int)n : 1;
+    }
+
+    thread_pool *pool = calloc(1, sizeof(*pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->threads = calloc(num_threads, sizeof(pthread_t));
+    pool->workers = calloc(num_threads, sizeof(pool_worker));
+    pool->ranges = aligned_malloc(num_threads * sizeof(work_range));
+    if (!pool->threads || !pool->workers || !pool->ranges) {
+        free(pool->threads);
+        free(pool->workers);
+        free(pool->ranges);
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    pool->num_threads = 1;
+    for (int t = 1; t < num_threads; t++) {
+        pool->workers[t].pool = pool;
+        pool->workers[t].index = t;
+        if (pthread_create(&pool->threads[t], NULL, pool_thread_main, &pool->workers[t]) != 0) {
+            break;
+        }
+        pool->num_threads++;
+    }
+    return pool;
+}
+
+// ✅ 스레드 풀 종료 및 해제
+void thread_pool_destroy(thread_pool *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int t = 1; t < pool->num_threads; t++) {
+        pthread_join(pool->threads[t], NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool->ranges);
+    free(pool);
+}
+
+// ✅ [0, count) 를 워커 수만큼 연속 구간으로 나눠 병렬 실행 (모두 끝나면 반환)
+void thread_pool_run(thread_pool *pool, int count, int chunk, parallel_fn fn, void *ctx) {
+    if (pool == NULL || pool->num_threads == 1 || count <= chunk) {
+        if (count > 0) {
+            fn(ctx, 0, count);
+        }
+        return;
+    }
+
+    int T = pool->num_threads;
+    for (int t = 0; t < T; t++) {
+        atomic_store(&pool->ranges[t].next, (int)((long long)count * t / T));
+        pool->ranges[t].end = (int)((long long)count * (t + 1) / T);
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->chunk = chunk;
+    pool->running = T - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    pool_work(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// 아레나 블록 (연속 메모리, 앞에서부터 잘라 씀)
+typedef struct arena_block {
+    struct arena_block *next;
+    size_t size;
+    size_t used;
+    unsigned char *data;  // IMAGE_ALIGN 정렬
+} arena_block;
+
+// 프레임 임시 버퍼용 아레나: 블록을 해제하지 않고 커서만 되돌려 재사용
+typedef struct {
+    arena_block *first;
+    arena_block *current;
+    size_t block_size;  // 새 블록 최소 크기
+} arena;
+
+// 아레나 위치 (arena_release 로 이 시점 이후 할당을 한 번에 되돌림)
+typedef struct {
+    arena_block *block;
+    size_t used;
+} arena_mark;
+
+#define ARENA_BLOCK_SIZE (1 << 20)
+
+// ✅ 아레나 초기화 (블록은 처음 할당할 때 만듦)
+void arena_init(arena *a, size_t block_size) {
+    a->first = a->current = NULL;
+    a->block_size = block_size > 0 ? block_size : ARENA_BLOCK_SIZE;
+}
+
+// ✅ 아레나의 모든 블록 해제
+void arena_destroy(arena *a) {
+    arena_block *b = a->first;
+    while (b != NULL) {
+        arena_block *next = b->next;
+        free(b->data);
+        free(b);
+        b = next;
+    }
+    a->first = a->current = NULL;
+}
+
+// ✅ IMAGE_ALIGN 정렬된 임시 메모리 할당 (내용은 정의되지 않음, 실패 시 NULL)
+// 현재 블록이 모자라면 이미 있는 다음 블록을 비워 쓰고, 없을 때만 새 블록을 끼워 넣음
+void *arena_alloc(arena *a, size_t bytes) {
+    bytes = (bytes + IMAGE_ALIGN - 1) / IMAGE_ALIGN * IMAGE_ALIGN;
+    arena_block *b = a->current;
+    if (b != NULL && b->size - b->used >= bytes) {
+        void *p = b->data + b->used;
+        b->used += bytes;
+        return p;
+    }
+
+    arena_block *next = (b != NULL) ? b->next : a->first;
+    if (next == NULL || next->size < bytes) {
+        arena_block *nb = malloc(sizeof(arena_block));
+        size_t size = bytes > a->block_size ? bytes : a->block_size;
+        if (nb == NULL || (nb->data = aligned_malloc(size)) == NULL) {
+            free(nb);
+            return NULL;
+        }
+        nb->size = size;
+        nb->next = next;
+        if (b != NULL) {
+            b->next = nb;
+        } else {
+            a->first = nb;
+        }
+        next = nb;
+    }
+    next->used = bytes;
+    a->current = next;
+    return next->data;
+}
+
+// ✅ 현재 위치 기록
+arena_mark arena_get_mark(const arena *a) {
+    arena_mark m = {a->current, a->current != NULL ? a->current->used : 0};
+    return m;
+}
+
+// ✅ 기록한 위치 이후의 할당을 모두 되돌림 (O(1))
+void arena_release(arena *a, arena_mark m) {
+    a->current = m.block;
+    if (m.block != NULL) {
+        m.block->used = m.used;
+    }
+}
+
+// ✅ 아레나 전체를 비움 (O(1), 블록은 다음 프레임에서 재사용)
+void arena_reset(arena *a) {
+    a->current = NULL;
+}
+
+static pthread_key_t thread_arena_key;
+static pthread_once_t thread_arena_once = PTHREAD_ONCE_INIT;
+
+// ✅ 스레드 종료 시 그 스레드의 아레나 해제
+static void thread_arena_free(void *p) {
+    arena_destroy(p);
+    free(p);
+}
+
+static void thread_arena_key_init(void) {
+    pthread_key_create(&thread_arena_key, thread_arena_free);
+}
+
+// ✅ 호출 스레드 전용 아레나 (처음 호출 시 생성, 실패 시 NULL)
+arena *thread_arena(void) {
+    pthread_once(&thread_arena_once, thread_arena_key_init);
+    arena *a = pthread_getspecific(thread_arena_key);
+    if (a == NULL && (a = malloc(sizeof(arena))) != NULL) {
+        arena_init(a, 0);
+        if (pthread_setspecific(thread_arena_key, a) != 0) {
+            free(a);
+            a = NULL;
+        }
+    }
+    return a;
+}
+
+// ✅ 행렬-벡터 곱셈 (rows x cols 행 우선)
+void multiply_matrix_vector(const double *A, int rows, int cols, const double *b, double *k) {
+    for (int i = 0; i < rows; i++) {
+        const double *a = A + (size_t)i * cols;
+        double sum = 0;
+        for (int j = 0; j < cols; j++) {
+            sum += a[j] * b[j];
+        }
+        k[i] = sum;
+    }
 }
 
 // ✅ 행렬 전치
-void transpose_matrix(double A[PATCH_SIZE][MATRIX_SIZE], double At[MATRIX_SIZE][PATCH_SIZE]) {
-    for (int i = 0; i < PATCH_SIZE; i++)
-        for (int j = 0; j < MATRIX_SIZE; j++)
-            At[j][i] = A[i][j];
+void transpose_matrix(const double *A, int rows, int cols, double *At) {
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            At[j * rows + i] = A[i * cols + j];
 }
 
 // ✅ 행렬 곱셈
-void multiply_matrices(double A[MATRIX_SIZE][PATCH_SIZE], double B[PATCH_SIZE][MATRIX_SIZE], double C[MATRIX_SIZE][MATRIX_SIZE]) {
-    for (int i = 0; i < MATRIX_SIZE; i++) {
-        for (int j = 0; j < MATRIX_SIZE; j++) {
-            C[i][j] = 0;
-            for (int k = 0; k < PATCH_SIZE; k++) {
-                C[i][j] += A[i][k] * B[k][j];
+void multiply_matrices(const double *A, const double *B, double *C, int A_rows, int A_cols, int B_cols) {
+    for (int i = 0; i < A_rows; i++) {
+        for (int j = 0; j < B_cols; j++) {
+            double sum = 0;
+            for (int k = 0; k < A_cols; k++) {
+                sum += A[i * A_cols + k] * B[k * B_cols + j];
             }
+            C[i * B_cols + j] = sum;
         }
     }
 }
 
-// ✅ 6x6 행렬 역행렬 (가우스-조던 소거법)
-void inverse_matrix_6x6(double A[MATRIX_SIZE][MATRIX_SIZE], double A_inv[MATRIX_SIZE][MATRIX_SIZE]) {
-    double temp[MATRIX_SIZE][MATRIX_SIZE * 2];
+// 선형계 풀이 결과
+enum {
+    SOLVE_OK = 0,         // LDLᵀ 분해로 풂
+    SOLVE_PIVOTED = 1,    // 양의 정부호가 아니어서 부분 피벗 소거로 풂
+    SOLVE_SINGULAR = -1,  // 특이 행렬 (X 는 정의되지 않음)
+};
+
+// ✅ 대칭 양의 정부호 n x n 행렬의 LDLᵀ 분해 (F 의 하삼각에 L, 대각에 D, 피벗이 작으면 -1)
+static inline int ldlt_factor(const double *A, int n, double *F) {
+    double scale = 0.0;
+    for (int i = 0; i < n; i++) {
+        scale = fmax(scale, fabs(A[i * n + i]));
+    }
+    double tol = 1e-13 * scale;
 
-    for (int i = 0; i < MATRIX_SIZE; i++) {
-        for (int j = 0; j < MATRIX_SIZE; j++) {
-            temp[i][j] = A[i][j];
-            temp[i][j + MATRIX_SIZE] = (i == j) ? 1.0 : 0.0;
+    for (int j = 0; j < n; j++) {
+        double d = A[j * n + j];
+        for (int k = 0; k < j; k++) {
+            d -= F[j * n + k] * F[j * n + k] * F[k * n + k];
+        }
+        if (!(d > tol)) {
+            return -1;
+        }
+        F[j * n + j] = d;
+        for (int i = j + 1; i < n; i++) {
+            double s = A[i * n + j];
+            for (int k = 0; k < j; k++) {
+                s -= F[i * n + k] * F[j * n + k] * F[k * n + k];
+            }
+            F[i * n + j] = s / d;
         }
     }
+    return 0;
+}
 
-    for (int i = 0; i < MATRIX_SIZE; i++) {
-        double pivot = temp[i][i];
-        if (fabs(pivot) < 1e-6) {
-            printf("Singular matrix, cannot invert!\n");
-            return;
+// ✅ LDLᵀ 분해로 A X = B 풀이 (B, X: n x nrhs 행 우선, X == B 가능)
+static inline void ldlt_solve(const double *F, int n, const double *B, int nrhs, double *X) {
+    if (X != B) {
+        memcpy(X, B, (size_t)n * nrhs * sizeof(double));
+    }
+    for (int i = 0; i < n; i++) {
+        for (int k = 0; k < i; k++) {
+            double l = F[i * n + k];
+            for (int c = 0; c < nrhs; c++) {
+                X[(size_t)i * nrhs + c] -= l * X[(size_t)k * nrhs + c];
+            }
         }
-        for (int j = 0; j < MATRIX_SIZE * 2; j++) {
-            temp[i][j] /= pivot;
+    }
+    for (int i = 0; i < n; i++) {
+        double inv_d = 1.0 / F[i * n + i];
+        for (int c = 0; c < nrhs; c++) {
+            X[(size_t)i * nrhs + c] *= inv_d;
         }
-        for (int k = 0; k < MATRIX_SIZE; k++) {
-            if (k != i) {
-                double factor = temp[k][i];
-                for (int j = 0; j < MATRIX_SIZE * 2; j++) {
-                    temp[k][j] -= factor * temp[i][j];
-                }
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        for (int k = i + 1; k < n; k++) {
+            double l = F[k * n + i];
+            for (int c = 0; c < nrhs; c++) {
+                X[(size_t)i * nrhs + c] -= l * X[(size_t)k * nrhs + c];
+            }
+        }
+    }
+}
+
+// ✅ 부분 피벗 가우스 소거로 A X = B 풀이 (일반 행렬용, 특이하면 -1)
+static int pivot_solve(const double *A, int n, const double *B, int nrhs, double *X) {
+    double M[MAX_TERMS * MAX_TERMS];
+    double scale = 0.0;
+    memcpy(M, A, (size_t)n * n * sizeof(double));
+    if (X != B) {
+        memcpy(X, B, (size_t)n * nrhs * sizeof(double));
+    }
+    for (int i = 0; i < n * n; i++) {
+        scale = fmax(scale, fabs(M[i]));
+    }
+
+    for (int i = 0; i < n; i++) {
+        int p = i;
+        for (int k = i + 1; k < n; k++) {
+            if (fabs(M[k * n + i]) > fabs(M[p * n + i])) {
+                p = k;
+            }
+        }
+        if (!(fabs(M[p * n + i]) > 1e-13 * scale)) {
+            return -1;
+        }
+        if (p != i) {
+            for (int j = 0; j < n; j++) {
+                double t = M[i * n + j];
+                M[i * n + j] = M[p * n + j];
+                M[p * n + j] = t;
+            }
+            for (int c = 0; c < nrhs; c++) {
+                double t = X[(size_t)i * nrhs + c];
+                X[(size_t)i * nrhs + c] = X[(size_t)p * nrhs + c];
+                X[(size_t)p * nrhs + c] = t;
+            }
+        }
+        for (int k = i + 1; k < n; k++) {
+            double f = M[k * n + i] / M[i * n + i];
+            for (int j = i; j < n; j++) {
+                M[k * n + j] -= f * M[i * n + j];
+            }
+            for (int c = 0; c < nrhs; c++) {
+                X[(size_t)k * nrhs + c] -= f * X[(size_t)i * nrhs + c];
             }
         }
     }
 
-    for (int i = 0; i < MATRIX_SIZE; i++) {
-        for (int j = 0; j < MATRIX_SIZE; j++) {
-            A_inv[i][j] = temp[i][j + MATRIX_SIZE];
+    for (int i = n - 1; i >= 0; i--) {
+        for (int k = i + 1; k < n; k++) {
+            double m = M[i * n + k];
+            for (int c = 0; c < nrhs; c++) {
+                X[(size_t)i * nrhs + c] -= m * X[(size_t)k * nrhs + c];
+            }
+        }
+        double inv = 1.0 / M[i * n + i];
+        for (int c = 0; c < nrhs; c++) {
+            X[(size_t)i * nrhs + c] *= inv;
         }
     }
+    return 0;
 }
 
-// ✅ 이미지 패치 추출 (bilinear interpolation)
-void get_image_patch_with_mask(
-    double img[HEIGHT][WIDTH], double mask[KERNEL_SIZE][KERNEL_SIZE], 
-    double u, double v, int r, double img_sub[PATCH_SIZE], int *num_valid
+// ✅ 정규방정식 (AᵀA) X = B 풀이 (B, X: n x nrhs 행 우선, n <= MAX_TERMS)
+// 결과: SOLVE_OK / SOLVE_PIVOTED / SOLVE_SINGULAR
+// 피팅 연산자는 반경/차수별로 한 번만 풀어 캐시하므로 코너마다 푸는 정규방정식은 없음
+int solve_normal_equations(const double *AtA, int n, const double *B, int nrhs, double *X) {
+    double F[MAX_TERMS * MAX_TERMS];
+    if (n < 1 || n > MAX_TERMS) {
+        return SOLVE_SINGULAR;
+    }
+    if (ldlt_factor(AtA, n, F) == 0) {
+        ldlt_solve(F, n, B, nrhs, X);
+        return SOLVE_OK;
+    }
+    return (pivot_solve(AtA, n, B, nrhs, X) == 0) ? SOLVE_PIVOTED : SOLVE_SINGULAR;
+}
+
+// ✅ n x n 행렬 역행렬 (n <= MAX_TERMS, 결과 상태는 solve_normal_equations 와 같음)
+int inverse_matrix_nxn(const double *A, int n, double *A_inv) {
+    if (n < 1 || n > MAX_TERMS) {
+        return SOLVE_SINGULAR;
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            A_inv[i * n + j] = (i == j) ? 1.0 : 0.0;
+        }
+    }
+    return solve_normal_equations(A, n, A_inv, n, A_inv);
+}
+
+// ✅ 6x6 행렬 역행렬
+int inverse_matrix_6x6(double A[MATRIX_SIZE][MATRIX_SIZE], double A_inv[MATRIX_SIZE][MATRIX_SIZE]) {
+    return inverse_matrix_nxn(&A[0][0], MATRIX_SIZE, &A_inv[0][0]);
+}
+
+// ✅ 의사역행렬 (AᵀA)⁻¹Aᵀ 계산 (A: rows x terms), 역행렬 없이 (AᵀA) X = Aᵀ 를 바로 풂
+int compute_invAtAAt(const double *A, int rows, int terms, double *invAtAAt) {
+    double At[MAX_TERMS * MAX_PATCH_SIZE];
+    double AtA[MAX_TERMS * MAX_TERMS];
+
+    transpose_matrix(A, rows, terms, At);
+    multiply_matrices(At, A, AtA, terms, rows, terms);
+    return solve_normal_equations(AtA, terms, At, rows, invAtAAt);
+}
+
+// ✅ 정렬된 힙 메모리에 이미지 할당 (성공 시 0)
+int image_create(image_view *img, int width, int height) {
+    int per_line = IMAGE_ALIGN / (int)sizeof(double);
+    int stride = (width + per_line - 1) / per_line * per_line;
+    size_t bytes = (size_t)stride * height * sizeof(double);
+
+    img->data = aligned_alloc(IMAGE_ALIGN, bytes);
+    if (img->data == NULL) {
+        img->width = img->height = img->stride = 0;
+        return -1;
+    }
+    memset(img->data, 0, bytes);
+    img->width = width;
+    img->height = height;
+    img->stride = stride;
+    return 0;
+}
+
+// ✅ 아레나에서 이미지 할당 (내용은 정의되지 않음, 해제는 arena_release/arena_reset, 성공 시 0)
+int image_create_arena(arena *a, image_view *img, int width, int height) {
+    int per_line = IMAGE_ALIGN / (int)sizeof(double);
+    int stride = (width + per_line - 1) / per_line * per_line;
+
+    img->data = (a != NULL) ? arena_alloc(a, (size_t)stride * height * sizeof(double)) : NULL;
+    if (img->data == NULL) {
+        img->width = img->height = img->stride = 0;
+        return -1;
+    }
+    img->width = width;
+    img->height = height;
+    img->stride = stride;
+    return 0;
+}
+
+// ✅ 이미지 메모리 해제
+void image_destroy(image_view *img) {
+    free(img->data);
+    img->data = NULL;
+    img->width = img->height = img->stride = 0;
+}
+
+// ✅ PGM(P5, 8/16비트) 파일 읽기 (성공 시 0)
+int image_load_pgm(const char *path, image_view *img) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    int width, height, maxval;
+    if (fscanf(fp, "P5 %d %d %d", &width, &height, &maxval) != 3 ||
+        width <= 0 || height <= 0 || maxval <= 0 || maxval > 65535) {
+        fclose(fp);
+        return -1;
+    }
+    fgetc(fp);  // 헤더 뒤 공백 한 글자
+
+    if (image_create(img, width, height) != 0) {
+        fclose(fp);
+        return -1;
+    }
+
+    int bpp = (maxval > 255) ? 2 : 1;
+    unsigned char *row = malloc((size_t)width * bpp);
+    int status = (row == NULL) ? -1 : 0;
+    for (int y = 0; y < height && status == 0; y++) {
+        if (fread(row, bpp, width, fp) != (size_t)width) {
+            status = -1;
+            break;
+        }
+        for (int x = 0; x < width; x++) {
+            PIXEL(img, x, y) = (bpp == 2) ? (row[2 * x] << 8 | row[2 * x + 1]) : row[x];
+        }
+    }
+
+    free(row);
+    fclose(fp);
+    if (status != 0) {
+        image_destroy(img);
+    }
+    return status;
+}
+
+// ✅ PGM(P5, 8/16비트)을 변환 없이 *buffer 에 읽음 (용량이 모자랄 때만 다시 할당, 성공 시 0)
+int image_load_pgm_into(const char *path, unsigned char **buffer, size_t *capacity, image_source *src) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    int width, height, maxval;
+    if (fscanf(fp, "P5 %d %d %d", &width, &height, &maxval) != 3 ||
+        width <= 0 || height <= 0 || maxval <= 0 || maxval > 65535) {
+        fclose(fp);
+        return -1;
+    }
+    fgetc(fp);  // 헤더 뒤 공백 한 글자
+
+    int bpp = (maxval > 255) ? 2 : 1;
+    size_t count = (size_t)width * height;
+    if (*capacity < count * bpp) {
+        unsigned char *grown = realloc(*buffer, count * bpp);
+        if (grown == NULL) {
+            fclose(fp);
+            return -1;
+        }
+        *buffer = grown;
+        *capacity = count * bpp;
+    }
+    unsigned char *data = *buffer;
+    if (fread(data, bpp, count, fp) != count) {
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    if (bpp == 2) {
+        // PGM 은 빅엔디언, 제자리에서 호스트 순서로 바꿈
+        uint16_t *px = (uint16_t *)data;
+        for (size_t i = 0; i < count; i++) {
+            px[i] = (uint16_t)(data[2 * i] << 8 | data[2 * i + 1]);
+        }
+    }
+
+    src->data = data;
+    src->width = width;
+    src->height = height;
+    src->stride = width;
+    src->format = (bpp == 2) ? PIXEL_U16 : PIXEL_U8;
+    return 0;
+}
+
+// ✅ PGM(P5, 8/16비트)을 변환 없이 읽음 (src->data 는 호출자가 free, 성공 시 0)
+int image_load_pgm_raw(const char *path, image_source *src) {
+    unsigned char *buffer = NULL;
+    size_t capacity = 0;
+    if (image_load_pgm_into(path, &buffer, &capacity, src) != 0) {
+        free(buffer);
+        return -1;
+    }
+    return 0;
+}
+
+// ✅ double 이미지를 원본으로 감쌈 (복사 없음)
+image_source image_source_view(const image_view *img) {
+    image_source src = {img->data, img->width, img->height, img->stride, PIXEL_F64};
+    return src;
+}
+
+// ✅ 8비트 버퍼를 원본으로 감쌈 (stride: 한 행의 원소 수, 복사 없음)
+image_source image_source_u8(const uint8_t *data, int width, int height, int stride) {
+    image_source src = {data, width, height, stride, PIXEL_U8};
+    return src;
+}
+
+// ✅ 16비트 버퍼를 원본으로 감쌈 (stride: 한 행의 원소 수, 복사 없음)
+image_source image_source_u16(const uint16_t *data, int width, int height, int stride) {
+    image_source src = {data, width, height, stride, PIXEL_U16};
+    return src;
+}
+
+// ✅ 원본의 사각형 [x0, x1) x [y0, y1) 을 복사 없이 감쌈 (좌표는 호출자가 범위 안으로 맞춤)
+image_source image_source_crop(const image_source *src, int x0, int y0, int x1, int y1) {
+    size_t elem = (src->format == PIXEL_U8) ? 1 : (src->format == PIXEL_U16) ? 2 : sizeof(double);
+    image_source crop = *src;
+    crop.data = (const unsigned char *)src->data + ((size_t)y0 * src->stride + x0) * elem;
+    crop.width = x1 - x0;
+    crop.height = y1 - y0;
+    return crop;
+}
+
+// ✅ 원본 버퍼의 i 번째 원소를 double 로 읽음 (fmt 가 상수면 분기가 사라짐)
+static inline double source_load(const void *data, pixel_format fmt, size_t i) {
+    switch (fmt) {
+    case PIXEL_U8:
+        return ((const uint8_t *)data)[i];
+    case PIXEL_U16:
+        return ((const uint16_t *)data)[i];
+    default:
+        return ((const double *)data)[i];
+    }
+}
+
+// ✅ 원본 픽셀 (x, y) 를 double 로 읽음
+static inline double source_at(const image_source *src, int x, int y) {
+    return source_load(src->data, src->format, (size_t)y * src->stride + x);
+}
+
+// ✅ 마스크 안쪽 샘플을 step 간격으로 기록 (bilinear interpolation, 샘플 수 반환)
+static int sample_patch_strided(
+    const image_source *img, const double *mask,
+    double u, double v, int r, double *out, int step
 ) {
     int iu = (int)u;
     int iv = (int)v;
@@ -106,133 +959,2759 @@ void get_image_patch_with_mask(
     double a10 = dv - du * dv;
     double a11 = du * dv;
 
-    *num_valid = 0;
+    int n = 0;
     for (int j = -r; j <= r; j++) {
         for (int i = -r; i <= r; i++) {
-            if (mask[j + R][i + R] >= 1e-6) {
-                img_sub[*num_valid] =
-                    a00 * img[iv + j][iu + i] +
-                    a01 * img[iv + j][iu + i + 1] +
-                    a10 * img[iv + j + 1][iu + i] +
-                    a11 * img[iv + j + 1][iu + i + 1];
-                (*num_valid)++;
+            if (mask[(j + r) * (2 * r + 1) + i + r] >= 1e-6) {
+                out[(size_t)n * step] =
+                    a00 * source_at(img, iu + i, iv + j) +
+                    a01 * source_at(img, iu + i + 1, iv + j) +
+                    a10 * source_at(img, iu + i, iv + j + 1) +
+                    a11 * source_at(img, iu + i + 1, iv + j + 1);
+                n++;
             }
         }
     }
+    return n;
+}
+
+// ✅ 이미지 패치 추출 (bilinear interpolation)
+void get_image_patch_with_mask(
+    const image_view *img, const double *mask, 
+    double u, double v, int r, double *img_sub, int *num_valid
+) {
+    image_source src = image_source_view(img);
+    *num_valid = sample_patch_strided(&src, mask, u, v, r, img_sub, 1);
+}
+
+// ✅ 8/16비트 원본에서 바로 패치 추출 (bilinear interpolation)
+void get_image_patch_with_mask_source(
+    const image_source *src, const double *mask,
+    double u, double v, int r, double *img_sub, int *num_valid
+) {
+    *num_valid = sample_patch_strided(src, mask, u, v, r, img_sub, 1);
 }
 
-// ✅ create_cone_filter_kernel() 추가
-int create_cone_filter_kernel(double kernel[KERNEL_SIZE][KERNEL_SIZE]) {
+// ✅ create_cone_filter_kernel() 추가 (반경 r, (2r+1)x(2r+1) 행 우선)
+int create_cone_filter_kernel(double *kernel, int r) {
+    int size = 2 * r + 1;
     double sum = 0.0;
     int nzs = 0;
 
-    for (int i = -R; i <= R; i++) {
-        for (int j = -R; j <= R; j++) {
-            kernel[i + R][j + R] = fmax(0.0, R + 1 - sqrt(i * i + j * j));
-            sum += kernel[i + R][j + R];
-            if (kernel[i + R][j + R] < 1e-6) {
+    for (int i = -r; i <= r; i++) {
+        for (int j = -r; j <= r; j++) {
+            double w = fmax(0.0, r + 1 - sqrt(i * i + j * j));
+            kernel[(i + r) * size + j + r] = w;
+            sum += w;
+            if (w < 1e-6) {
                 nzs++;
             }
         }
     }
 
-    for (int i = 0; i < KERNEL_SIZE; i++) {
-        for (int j = 0; j < KERNEL_SIZE; j++) {
-            kernel[i][j] /= sum;
-        }
+    for (int i = 0; i < size * size; i++) {
+        kernel[i] /= sum;
     }
 
     return nzs;
 }
 
+// 반경/차수별 최소자승 피팅 연산자 (프로세스 전역 캐시)
+typedef struct {
+    int r;
+    int order;          // 다항식 차수 (2 또는 3)
+    int terms;          // 다항식 항 수 (2차: 6, 3차: 10)
+    int num_valid;      // 마스크 안쪽 샘플 수 N
+    double *mask;       // 원뿔 마스크 (2r+1)^2
+    double *invAtAAt;   // terms x N 행 우선
+    double *dense;      // terms x (2r+1)^2 행 우선, 마스크 밖 열은 0 (반경 고정 커널용)
+    double *phase;      // 위상 표 PHASE_STEPS² x terms x (2r+2)^2 (get_phase_table 에서 생성)
+} fit_operator;
 
+static fit_operator fit_cache[2][MAX_R + 1];  // [차수 - 2][반경]
+static pthread_mutex_t fit_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 
+// ✅ 설계 행렬 A 한 행
+// 2차: x², y², xy, x, y, 1
+// 3차: x³, x²y, xy², y³, 뒤에 2차 항 (마지막 6개는 2차와 같은 순서)
+static int design_row(int order, int i, int j, double *row) {
+    switch (order) {
+    case 3:
+        row[0] = i * i * i;
+        row[1] = i * i * j;
+        row[2] = i * j * j;
+        row[3] = j * j * j;
+        return 4 + design_row(2, i, j, row + 4);
+    case 2:
+        row[0] = i * i;
+        row[1] = j * j;
+        row[2] = i * j;
+        row[3] = i;
+        row[4] = j;
+        row[5] = 1;
+        return 6;
+    default:
+        return 0;
+    }
+}
 
-// ✅ Saddle Point 검출 (polynomial_fit_saddle)
-void polynomial_fit_saddle(double img[HEIGHT][WIDTH], Corner2* corners) {
-    double blur_kernel[KERNEL_SIZE][KERNEL_SIZE];
-    double mask[KERNEL_SIZE][KERNEL_SIZE];
-    double blur_img[HEIGHT][WIDTH] = {0}; 
+// ✅ 피팅 연산자 생성 (마스크, (AᵀA)⁻¹Aᵀ)
+static int build_fit_operator(fit_operator *op, int r, int order) {
+    int size = 2 * r + 1;
+    double row[MAX_TERMS];
+    double *A = malloc((size_t)size * size * MAX_TERMS * sizeof(double));
 
-    create_cone_filter_kernel(blur_kernel);
-    int nzs = create_cone_filter_kernel(mask);
-    apply_convolution(img, blur_kernel, blur_img);
+    op->r = r;
+    op->order = order;
+    op->terms = design_row(order, 0, 0, row);
+    op->mask = aligned_malloc((size_t)size * size * sizeof(double));
+    op->invAtAAt = aligned_malloc((size_t)MAX_TERMS * size * size * sizeof(double));
+    op->dense = aligned_malloc((size_t)MAX_TERMS * size * size * sizeof(double));
+    if (A == NULL || op->terms == 0 || op->mask == NULL || op->invAtAAt == NULL || op->dense == NULL) {
+        free(A);
+        free(op->mask);
+        free(op->invAtAAt);
+        free(op->dense);
+        memset(op, 0, sizeof(*op));
+        return -1;
+    }
 
-    double A[PATCH_SIZE][MATRIX_SIZE] = {0};
-    int A_row = 0;
-    for (int j = -R; j <= R; j++) {
-        for (int i = -R; i <= R; i++) {
-            if (mask[j + R][i + R] >= 1e-6) {
-                A[A_row][0] = i * i;
-                A[A_row][1] = j * j;
-                A[A_row][2] = i * j;
-                A[A_row][3] = i;
-                A[A_row][4] = j;
-                A[A_row][5] = 1;
-                A_row++;
+    create_cone_filter_kernel(op->mask, r);
+    op->num_valid = 0;
+    for (int j = -r; j <= r; j++) {
+        for (int i = -r; i <= r; i++) {
+            if (op->mask[(j + r) * size + i + r] >= 1e-6) {
+                design_row(order, i, j, A + (size_t)op->num_valid * op->terms);
+                op->num_valid++;
             }
         }
     }
 
-    double At[MATRIX_SIZE][PATCH_SIZE];
-    double AtA[MATRIX_SIZE][MATRIX_SIZE];
-    double AtA_inv[MATRIX_SIZE][MATRIX_SIZE];
-    double invAtAAt[MATRIX_SIZE][PATCH_SIZE];
+    if (compute_invAtAAt(A, op->num_valid, op->terms, op->invAtAAt) < 0) {
+        free(A);
+        free(op->mask);
+        free(op->invAtAAt);
+        free(op->dense);
+        memset(op, 0, sizeof(*op));
+        return -1;
+    }
+    free(A);
 
-    transpose_matrix(A, At);
-    multiply_matrices(At, A, AtA);
-    inverse_matrix_6x6(AtA, AtA_inv);
-    multiply_matrices(AtA_inv, At, invAtAAt);
+    // 정사각 패치 전체에 대한 연산자 (마스크 밖 샘플의 가중치는 0)
+    memset(op->dense, 0, (size_t)op->terms * size * size * sizeof(double));
+    for (int t = 0; t < op->terms; t++) {
+        int n = 0;
+        for (int p = 0; p < size * size; p++) {
+            if (op->mask[p] >= 1e-6) {
+                op->dense[(size_t)t * size * size + p] = op->invAtAAt[(size_t)t * op->num_valid + n++];
+            }
+        }
+    }
+    return 0;
+}
 
-    int choose[MAX_CORNERS] = {0};
-    Corner2 corners_out;
-    corners_out.Size = 0;
+// ✅ 캐시된 피팅 연산자 조회 (처음 요청 시 생성, 실패 시 NULL)
+const fit_operator *get_fit_operator(int r, int order) {
+    if (r < 1 || r > MAX_R || order < 2 || order > 3) {
+        return NULL;
+    }
+    fit_operator *op = &fit_cache[order - 2][r];
+    pthread_mutex_lock(&fit_cache_lock);
+    if (op->invAtAAt == NULL && build_fit_operator(op, r, order) != 0) {
+        op = NULL;
+    }
+    pthread_mutex_unlock(&fit_cache_lock);
+    return op;
+}
 
-    for (int i = 0; i < corners->Size; i++) {
-        double u_cur = corners->p[i].x;
-        double v_cur = corners->p[i].y;
-        int is_saddle_point = 1;
+// ✅ 위상 표 생성: 위상 (pu, pv) / PHASE_STEPS 의 양선형 보간을 dense 연산자에 접어 넣음
+// 표[위상][t] 는 (iu - r, iv - r) 부터 (2r+2)² 원본 픽셀을 바로 계수 t 로 보내는 가중치
+static double *build_phase_table(const fit_operator *op) {
+    int r = op->r, size = 2 * r + 1, S = size + 1;
+    size_t per_phase = (size_t)op->terms * S * S;
+    double *table = aligned_malloc((size_t)PHASE_STEPS * PHASE_STEPS * per_phase * sizeof(double));
+    if (table == NULL) {
+        return NULL;
+    }
+    memset(table, 0, (size_t)PHASE_STEPS * PHASE_STEPS * per_phase * sizeof(double));
+    for (int pv = 0; pv < PHASE_STEPS; pv++) {
+        for (int pu = 0; pu < PHASE_STEPS; pu++) {
+            double du = (double)pu / PHASE_STEPS, dv = (double)pv / PHASE_STEPS;
+            double a00 = 1 - du - dv + du * dv, a01 = du - du * dv, a10 = dv - du * dv, a11 = du * dv;
+            double *w = table + (size_t)(pv * PHASE_STEPS + pu) * per_phase;
+            for (int t = 0; t < op->terms; t++) {
+                const double *d = op->dense + (size_t)t * size * size;
+                double *wt = w + (size_t)t * S * S;
+                for (int j = 0; j < size; j++) {
+                    for (int i = 0; i < size; i++) {
+                        double c = d[j * size + i];
+                        wt[j * S + i] += a00 * c;
+                        wt[j * S + i + 1] += a01 * c;
+                        wt[(j + 1) * S + i] += a10 * c;
+                        wt[(j + 1) * S + i + 1] += a11 * c;
+                    }
+                }
+            }
+        }
+    }
+    return table;
+}
+
+// ✅ 연산자의 위상 표 (처음 요청할 때 만들어 캐시, 실패 시 NULL)
+// 반경 4 에서 2차 4.9MB, 3차 8.2MB, 코너마다 위상별 가중치 (2차 4.8KB) 를 새로 읽어야 해서
+// 가중치를 FIT_BATCH 코너가 함께 쓰는 보간 경로보다 측정상 15~45% 느림 (그래서 기본값은 꺼짐)
+const double *get_phase_table(const fit_operator *op) {
+    fit_operator *cached = &fit_cache[op->order - 2][op->r];
+    pthread_mutex_lock(&fit_cache_lock);
+    if (cached->phase == NULL) {
+        cached->phase = build_phase_table(cached);
+    }
+    pthread_mutex_unlock(&fit_cache_lock);
+    return cached->phase;
+}
+
+// ✅ 위치를 위상 표 격자 (1/PHASE_STEPS 픽셀) 로 반올림
+static inline point2d phase_snap(point2d p) {
+    point2d q = {floor(p.x * PHASE_STEPS + 0.5) / PHASE_STEPS, floor(p.y * PHASE_STEPS + 0.5) / PHASE_STEPS};
+    return q;
+}
+
+// ✅ 출력 n 픽셀 컨볼루션: rows[ky] 는 입력 행 (y - r + ky) 에서 첫 출력의 x - r 위치
+static void convolve_span(const double *const *rows, const double *kernel, int r, int n, double *out) {
+    int size = 2 * r + 1;
+    for (int i = 0; i < n; i++) {
+        double sum = 0.0;
+        for (int ky = 0; ky < size; ky++) {
+            const double *row = rows[ky] + i;
+            const double *k = kernel + ky * size;
+            for (int kx = 0; kx < size; kx++) {
+                sum += row[kx] * k[kx];
+            }
+        }
+        out[i] = sum;
+    }
+}
+
+// ✅ 8/16비트 원본 행 [x0, x0 + n) 을 double 로 변환
+static void source_load_span(const image_source *img, int x0, int y, int n, double *dst) {
+    size_t base = (size_t)y * img->stride + x0;
+    if (img->format == PIXEL_U8) {
+        const uint8_t *p = (const uint8_t *)img->data + base;
+        for (int i = 0; i < n; i++) {
+            dst[i] = p[i];
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            dst[i] = source_load(img->data, img->format, base + i);
+        }
+    }
+}
+
+// ✅ 영역 [x0, x1) x [y0, y1) 컨볼루션, 결과 (x, y) 는 dst + (y - y0) * dst_stride + x 에 기록
+// 테두리 r 픽셀은 0, double 원본은 그대로 읽고 8/16비트 원본은 CONV_TILE 열 단위로 필요한 2r+1 행만 링 버퍼에 변환
+static void convolve_rect(const image_source *img, const double *kernel, int r,
+                          int x0, int x1, int y0, int y1, double *dst, int dst_stride) {
+    int size = 2 * r + 1;
+    int W = img->width, H = img->height;
+    const double *rows[MAX_KERNEL_SIZE];
+    int xs = (x0 > r) ? x0 : r;
+    int xe = (x1 < W - r) ? x1 : W - r;
+
+    // 테두리 (위아래 행 전체, 좌우 r 픽셀)
+    for (int y = y0; y < y1; y++) {
+        double *out = dst + (size_t)(y - y0) * dst_stride;
+        if (y < r || y >= H - r || xs >= xe) {
+            memset(out + x0, 0, (size_t)(x1 - x0) * sizeof(double));
+            continue;
+        }
+        if (x0 < xs) {
+            memset(out + x0, 0, (size_t)(xs - x0) * sizeof(double));
+        }
+        if (xe < x1) {
+            memset(out + xe, 0, (size_t)(x1 - xe) * sizeof(double));
+        }
+    }
+
+    int ys = (y0 > r) ? y0 : r;
+    int ye = (y1 < H - r) ? y1 : H - r;
+    if (ys >= ye || xs >= xe) {
+        return;
+    }
+
+    if (img->format == PIXEL_F64) {
+        const double *data = img->data;
+        for (int y = ys; y < ye; y++) {
+            for (int ky = 0; ky < size; ky++) {
+                rows[ky] = data + (size_t)(y - r + ky) * img->stride + xs - r;
+            }
+            convolve_span(rows, kernel, r, xe - xs, dst + (size_t)(y - y0) * dst_stride + xs);
+        }
+        return;
+    }
+
+    double ring[MAX_KERNEL_SIZE * (CONV_TILE + 2 * MAX_R)];
+    for (int tx = xs; tx < xe; tx += CONV_TILE) {
+        int n = (tx + CONV_TILE < xe) ? CONV_TILE : xe - tx;
+        int span = n + 2 * r;
+        for (int y = ys - r; y < ys + r; y++) {
+            source_load_span(img, tx - r, y, span, ring + (size_t)(y % size) * span);
+        }
+        for (int y = ys; y < ye; y++) {
+            source_load_span(img, tx - r, y + r, span, ring + (size_t)((y + r) % size) * span);
+            for (int ky = 0; ky < size; ky++) {
+                rows[ky] = ring + (size_t)((y - r + ky) % size) * span;
+            }
+            convolve_span(rows, kernel, r, n, dst + (size_t)(y - y0) * dst_stride + tx);
+        }
+    }
+}
+
+// ✅ 행 [y0, y1) 전체 폭 컨볼루션, 결과 행 y 는 dst + (y - y0) * dst_stride 에 기록
+static void convolve_rows(const image_source *img, const double *kernel, int r,
+                          int y0, int y1, double *dst, int dst_stride) {
+    convolve_rect(img, kernel, r, 0, img->width, y0, y1, dst, dst_stride);
+}
+
+// ✅ 컨볼루션 연산 (cv::filter2D 대체, 테두리 r 픽셀은 0)
+void apply_convolution(const image_view *img, const double *kernel, int r, image_view *output) {
+    image_source src = image_source_view(img);
+    convolve_rows(&src, kernel, r, 0, img->height, output->data, output->stride);
+}
+
+// 원뿔 커널의 고유분해 K = Σ λ_k u_k u_kᵀ (대칭이므로 SVD와 같음)
+typedef struct {
+    int r;
+    double lambda[MAX_KERNEL_SIZE];                   // |λ| 내림차순
+    double vec[MAX_KERNEL_SIZE][MAX_KERNEL_SIZE];     // vec[k] = u_k
+    double residual[MAX_KERNEL_SIZE + 1];             // residual[n] = Σ|K - 랭크 n 근사|
+} separable_kernel;
+
+static separable_kernel sep_cache[MAX_R + 1];
+
+// ✅ 대칭 행렬 고유분해 (야코비 회전, a는 파괴됨)
+static void jacobi_eigen(double *a, int n, double *lambda, double *vecs) {
+    for (int i = 0; i < n * n; i++) {
+        vecs[i] = (i / n == i % n) ? 1.0 : 0.0;
+    }
+
+    for (int sweep = 0; sweep < 50; sweep++) {
+        double off = 0;
+        for (int p = 0; p < n; p++)
+            for (int q = p + 1; q < n; q++)
+                off += a[p * n + q] * a[p * n + q];
+        if (off < 1e-30) {
+            break;
+        }
+
+        for (int p = 0; p < n; p++) {
+            for (int q = p + 1; q < n; q++) {
+                double apq = a[p * n + q];
+                if (fabs(apq) < 1e-300) {
+                    continue;
+                }
+                double theta = (a[q * n + q] - a[p * n + p]) / (2 * apq);
+                double t = (theta >= 0 ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1));
+                double c = 1 / sqrt(t * t + 1);
+                double s = t * c;
+
+                for (int k = 0; k < n; k++) {
+                    double akp = a[k * n + p], akq = a[k * n + q];
+                    a[k * n + p] = c * akp - s * akq;
+                    a[k * n + q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < n; k++) {
+                    double apk = a[p * n + k], aqk = a[q * n + k];
+                    a[p * n + k] = c * apk - s * aqk;
+                    a[q * n + k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < n; k++) {
+                    double vkp = vecs[k * n + p], vkq = vecs[k * n + q];
+                    vecs[k * n + p] = c * vkp - s * vkq;
+                    vecs[k * n + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        lambda[i] = a[i * n + i];
+    }
+}
+
+// ✅ 반경 r 원뿔 커널의 분리형 분해 계산
+static void build_separable_kernel(separable_kernel *sk, int r) {
+    int n = 2 * r + 1;
+    double kernel[MAX_KERNEL_SIZE * MAX_KERNEL_SIZE];
+    double a[MAX_KERNEL_SIZE * MAX_KERNEL_SIZE];
+    double lambda[MAX_KERNEL_SIZE];
+    double vecs[MAX_KERNEL_SIZE * MAX_KERNEL_SIZE];
+
+    create_cone_filter_kernel(kernel, r);
+    memcpy(a, kernel, n * n * sizeof(double));
+    jacobi_eigen(a, n, lambda, vecs);
+
+    // |λ| 내림차순 정렬 (선택 정렬, n <= 21)
+    int order[MAX_KERNEL_SIZE];
+    for (int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            if (fabs(lambda[order[j]]) > fabs(lambda[order[i]])) {
+                int t = order[i];
+                order[i] = order[j];
+                order[j] = t;
+            }
+        }
+    }
+    for (int k = 0; k < n; k++) {
+        sk->lambda[k] = lambda[order[k]];
+        for (int i = 0; i < n; i++) {
+            sk->vec[k][i] = vecs[i * n + order[k]];
+        }
+    }
+
+    // 랭크별 잔차: 출력 오차 <= residual[rank] * max|입력|
+    double approx[MAX_KERNEL_SIZE * MAX_KERNEL_SIZE] = {0};
+    for (int rank = 0; rank <= n; rank++) {
+        if (rank > 0) {
+            const double *u = sk->vec[rank - 1];
+            for (int i = 0; i < n; i++)
+                for (int j = 0; j < n; j++)
+                    approx[i * n + j] += sk->lambda[rank - 1] * u[i] * u[j];
+        }
+        double err = 0;
+        for (int i = 0; i < n * n; i++) {
+            err += fabs(kernel[i] - approx[i]);
+        }
+        sk->residual[rank] = err;
+    }
+
+    sk->r = r;
+}
+
+// ✅ 반경 r 원뿔 커널의 분리형 분해 조회 (처음 요청 시 생성, 피팅 연산자 캐시와 같은 잠금)
+static const separable_kernel *get_separable_kernel(int r) {
+    if (r < 1 || r > MAX_R) {
+        return NULL;
+    }
+    separable_kernel *sk = &sep_cache[r];
+    pthread_mutex_lock(&fit_cache_lock);
+    if (sk->r != r) {
+        build_separable_kernel(sk, r);
+    }
+    pthread_mutex_unlock(&fit_cache_lock);
+    return sk;
+}
+
+// ✅ 분리형 근사 컨볼루션 (행 패스 + 열 패스를 랭크만큼 누적, 사용한 랭크 반환)
+// 원본 행은 패스마다 한 행씩 double 로 변환해 읽음
+int apply_convolution_separable(const image_source *img, int r, double tol, image_view *output, double *max_deviation) {
+    const separable_kernel *sk = get_separable_kernel(r);
+    arena *a = thread_arena();
+    if (sk == NULL || a == NULL) {
+        return -1;
+    }
+    arena_mark mark = arena_get_mark(a);
+    image_view tmp;
+    double *line = arena_alloc(a, (size_t)img->width * sizeof(double));
+    if (line == NULL || image_create_arena(a, &tmp, img->width, img->height) != 0) {
+        arena_release(a, mark);
+        return -1;
+    }
+
+    int n = 2 * r + 1;
+    int rank = 1;
+    while (rank < n && sk->residual[rank] > tol) {
+        rank++;
+    }
+
+    for (int y = 0; y < img->height; y++)
+        for (int x = 0; x < img->width; x++)
+            PIXEL(output, x, y) = 0.0;
+
+    for (int k = 0; k < rank; k++) {
+        const double *u = sk->vec[k] + r;
+        double lambda = sk->lambda[k];
+
+        // 행 방향 1D 패스
+        for (int y = 0; y < img->height; y++) {
+            for (int x = 0; x < img->width; x++) {
+                line[x] = source_at(img, x, y);
+            }
+            for (int x = r; x < img->width - r; x++) {
+                const double *row = line + x;
+                double sum = 0.0;
+                for (int t = -r; t <= r; t++) {
+                    sum += row[t] * u[t];
+                }
+                PIXEL(&tmp, x, y) = sum;
+            }
+        }
+
+        // 열 방향 1D 패스 (λ 포함하여 누적)
+        for (int y = r; y < img->height - r; y++) {
+            for (int x = r; x < img->width - r; x++) {
+                double sum = 0.0;
+                for (int t = -r; t <= r; t++) {
+                    sum += PIXEL(&tmp, x, y + t) * u[t];
+                }
+                PIXEL(output, x, y) += lambda * sum;
+            }
+        }
+    }
+
+    if (max_deviation != NULL) {
+        *max_deviation = sk->residual[rank];
+    }
+    arena_release(a, mark);
+    return rank;
+}
+
+// ✅ float32 이미지 할당 (성공 시 0)
+int image_create_f32(image_view_f32 *img, int width, int height) {
+    int per_line = IMAGE_ALIGN / (int)sizeof(float);
+    int stride = (width + per_line - 1) / per_line * per_line;
+    size_t bytes = (size_t)stride * height * sizeof(float);
+
+    img->data = aligned_alloc(IMAGE_ALIGN, bytes);
+    if (img->data == NULL) {
+        img->width = img->height = img->stride = 0;
+        return -1;
+    }
+    memset(img->data, 0, bytes);
+    img->width = width;
+    img->height = height;
+    img->stride = stride;
+    return 0;
+}
+
+// ✅ 아레나에서 float32 이미지 할당 (내용은 정의되지 않음, 성공 시 0)
+int image_create_f32_arena(arena *a, image_view_f32 *img, int width, int height) {
+    int per_line = IMAGE_ALIGN / (int)sizeof(float);
+    int stride = (width + per_line - 1) / per_line * per_line;
+
+    img->data = (a != NULL) ? arena_alloc(a, (size_t)stride * height * sizeof(float)) : NULL;
+    if (img->data == NULL) {
+        img->width = img->height = img->stride = 0;
+        return -1;
+    }
+    img->width = width;
+    img->height = height;
+    img->stride = stride;
+    return 0;
+}
+
+// ✅ float32 이미지 해제
+void image_destroy_f32(image_view_f32 *img) {
+    free(img->data);
+    img->data = NULL;
+    img->width = img->height = img->stride = 0;
+}
+
+// 한 행 컨볼루션: dst[x] (x0 <= x < x1) 계산, src는 같은 행의 입력
+typedef void (*conv_row_f32_fn)(const float *src, int stride, const float *kernel, int r,
+                                float *dst, int x0, int x1);
+
+// ✅ 행 컨볼루션 (스칼라)
+static void conv_row_f32_scalar(const float *src, int stride, const float *kernel, int r,
+                                float *dst, int x0, int x1) {
+    int size = 2 * r + 1;
+    for (int x = x0; x < x1; x++) {
+        float sum = 0.0f;
+        for (int ky = -r; ky <= r; ky++) {
+            const float *row = src + (ptrdiff_t)ky * stride + x;
+            const float *k = kernel + (ky + r) * size + r;
+            for (int kx = -r; kx <= r; kx++) {
+                sum += row[kx] * k[kx];
+            }
+        }
+        dst[x] = sum;
+    }
+}
+
+#ifdef CALIB_X86
+// ✅ 행 컨볼루션 (AVX2 + FMA, 8픽셀씩)
+__attribute__((target("avx2,fma")))
+static void conv_row_f32_avx2(const float *src, int stride, const float *kernel, int r,
+                              float *dst, int x0, int x1) {
+    int size = 2 * r + 1;
+    int x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int ky = -r; ky <= r; ky++) {
+            const float *row = src + (ptrdiff_t)ky * stride + x;
+            const float *k = kernel + (ky + r) * size + r;
+            for (int kx = -r; kx <= r; kx++) {
+                acc = _mm256_fmadd_ps(_mm256_loadu_ps(row + kx), _mm256_broadcast_ss(k + kx), acc);
+            }
+        }
+        _mm256_storeu_ps(dst + x, acc);
+    }
+    conv_row_f32_scalar(src, stride, kernel, r, dst, x, x1);
+}
+#endif
+
+#ifdef __ARM_NEON
+// ✅ 행 컨볼루션 (NEON, 4픽셀씩)
+static void conv_row_f32_neon(const float *src, int stride, const float *kernel, int r,
+                              float *dst, int x0, int x1) {
+    int size = 2 * r + 1;
+    int x = x0;
+    for (; x + 4 <= x1; x += 4) {
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (int ky = -r; ky <= r; ky++) {
+            const float *row = src + (ptrdiff_t)ky * stride + x;
+            const float *k = kernel + (ky + r) * size + r;
+            for (int kx = -r; kx <= r; kx++) {
+                acc = vmlaq_n_f32(acc, vld1q_f32(row + kx), k[kx]);
+            }
+        }
+        vst1q_f32(dst + x, acc);
+    }
+    conv_row_f32_scalar(src, stride, kernel, r, dst, x, x1);
+}
+#endif
+
+static conv_row_f32_fn conv_row_f32_selected;
+static pthread_once_t conv_row_f32_once = PTHREAD_ONCE_INIT;
+
+static void conv_row_f32_select_init(void) {
+    conv_row_f32_selected = conv_row_f32_scalar;
+#ifdef CALIB_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        conv_row_f32_selected = conv_row_f32_avx2;
+    }
+#endif
+#ifdef __ARM_NEON
+    conv_row_f32_selected = conv_row_f32_neon;
+#endif
+}
+
+// ✅ CPU 기능에 맞는 행 컨볼루션 선택 (처음 한 번, 여러 스레드에서 불러도 안전)
+static conv_row_f32_fn select_conv_row_f32(void) {
+    pthread_once(&conv_row_f32_once, conv_row_f32_select_init);
+    return conv_row_f32_selected;
+}
+
+// ✅ float32 컨볼루션 (테두리 r 픽셀은 0)
+void apply_convolution_f32(const image_view_f32 *img, const float *kernel, int r, image_view_f32 *output) {
+    conv_row_f32_fn conv_row = select_conv_row_f32();
+
+    for (int y = 0; y < img->height; y++) {
+        float *dst = &PIXEL(output, 0, y);
+        if (y < r || y >= img->height - r || img->width <= 2 * r) {
+            memset(dst, 0, img->width * sizeof(float));
+            continue;
+        }
+        for (int x = 0; x < r; x++) {
+            dst[x] = 0.0f;
+            dst[img->width - 1 - x] = 0.0f;
+        }
+        conv_row(&PIXEL(img, 0, y), img->stride, kernel, r, dst, r, img->width - r);
+    }
+}
+
+// ✅ double 커널로 float32 블러 후 double 이미지로 되돌림 (성공 시 0)
+static int apply_convolution_via_f32(const image_source *img, const double *kernel, int r, image_view *output) {
+    image_view_f32 src, dst;
+    float kernel_f32[MAX_KERNEL_SIZE * MAX_KERNEL_SIZE];
+    arena *a = thread_arena();
+    if (a == NULL) {
+        return -1;
+    }
+
+    arena_mark mark = arena_get_mark(a);
+    if (image_create_f32_arena(a, &src, img->width, img->height) != 0 ||
+        image_create_f32_arena(a, &dst, img->width, img->height) != 0) {
+        arena_release(a, mark);
+        return -1;
+    }
+
+    for (int i = 0; i < (2 * r + 1) * (2 * r + 1); i++) {
+        kernel_f32[i] = (float)kernel[i];
+    }
+    for (int y = 0; y < img->height; y++)
+        for (int x = 0; x < img->width; x++)
+            PIXEL(&src, x, y) = (float)source_at(img, x, y);
+
+    apply_convolution_f32(&src, kernel_f32, r, &dst);
+
+    for (int y = 0; y < img->height; y++)
+        for (int x = 0; x < img->width; x++)
+            PIXEL(output, x, y) = PIXEL(&dst, x, y);
+
+    arena_release(a, mark);
+    return 0;
+}
+
+// 밴드 소비 함수: band 는 이미지 행 [band_y0, band_y0 + band->height) 의 블러 결과,
+// 그중 [y0, y1) 이 이 밴드 몫이고 나머지는 위/아래 halo
+typedef void (*band_fn)(void *ctx, const image_view *band, int band_y0, int y0, int y1);
+
+// 밴드 블러 작업 컨텍스트
+typedef struct {
+    image_source img;
+    const double *kernel;
+    int r;
+    int band_rows;
+    image_view *output;  // 출력 이미지 (fused 모드에서는 NULL)
+    int halo;
+    band_fn consumer;
+    void *consumer_ctx;
+    atomic_int failed;
+} band_job;
+
+#define BAND_HALO_MULT 8  // 밴드 높이 하한: 소비자 halo 의 배수 (위아래 halo 재계산이 밴드의 1/4 이하)
+
+// ✅ L2 캐시에 입력 (band + 2 halo + 2r) 행과 출력 (band + 2 halo) 행이 함께 들어가도록 밴드 높이 결정
+// 폭이 넓어 L2 로 모자라면 halo 재계산 비율이 커지지 않게 halo * BAND_HALO_MULT 행을 하한으로 둠
+int choose_band_rows(int width, int r, int halo) {
+    long l2 = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    if (l2 <= 0) {
+        l2 = 256 * 1024;
+    }
+    long row_bytes = (long)width * sizeof(double);
+    long rows = (l2 / 2 / row_bytes - 2 * r - 4 * halo) / 2;  // 절반만 사용 (다른 데이터 몫)
+    long min_rows = (long)halo * BAND_HALO_MULT;
+    if (min_rows < 8) {
+        min_rows = 8;
+    }
+    if (rows < min_rows) {
+        rows = min_rows;
+    }
+    return (int)rows;
+}
+
+// ✅ 밴드 [begin, end) 처리: 출력 이미지에 직접 쓰거나, halo 포함 버퍼를 만들어 소비자에 넘김
+static void blur_band_range(void *ctx, int begin, int end) {
+    band_job *job = ctx;
+    int H = job->img.height;
+
+    for (int b = begin; b < end; b++) {
+        int y0 = b * job->band_rows;
+        int y1 = (y0 + job->band_rows < H) ? y0 + job->band_rows : H;
+
+        if (job->consumer == NULL) {
+            convolve_rows(&job->img, job->kernel, job->r, y0, y1,
+                          &PIXEL(job->output, 0, y0), job->output->stride);
+            continue;
+        }
+
+        int by0 = (y0 - job->halo > 0) ? y0 - job->halo : 0;
+        int by1 = (y1 + job->halo < H) ? y1 + job->halo : H;
+        arena *a = thread_arena();
+        arena_mark mark = a != NULL ? arena_get_mark(a) : (arena_mark){NULL, 0};
+        image_view band;
+        if (image_create_arena(a, &band, job->img.width, by1 - by0) != 0) {
+            atomic_store(&job->failed, 1);
+            continue;
+        }
+        convolve_rows(&job->img, job->kernel, job->r, by0, by1, band.data, band.stride);
+        job->consumer(job->consumer_ctx, &band, by0, y0, y1);
+        arena_release(a, mark);
+    }
+}
+
+// ✅ 행 밴드 단위 병렬 컨볼루션 (band_rows <= 0 이면 L2 기준 자동)
+void apply_convolution_tiled(const image_source *img, const double *kernel, int r, image_view *output,
+                             thread_pool *pool, int band_rows) {
+    band_job job = {*img, kernel, r, band_rows > 0 ? band_rows : choose_band_rows(img->width, r, 0),
+                    output, 0, NULL, NULL, 0};
+    int num_bands = (img->height + job.band_rows - 1) / job.band_rows;
+    thread_pool_run(pool, num_bands, 1, blur_band_range, &job);
+}
+
+// ✅ 블러와 소비 단계를 밴드 단위로 결합 (전체 블러 이미지를 만들지 않음, 성공 시 0)
+// 소비자는 여러 스레드에서 동시에 호출될 수 있음
+int blur_bands_fused(const image_source *img, const double *kernel, int r, thread_pool *pool,
+                     int band_rows, int halo, band_fn consumer, void *consumer_ctx) {
+    band_job job = {*img, kernel, r, band_rows > 0 ? band_rows : choose_band_rows(img->width, r, halo),
+                    NULL, halo, consumer, consumer_ctx, 0};
+    int num_bands = (img->height + job.band_rows - 1) / job.band_rows;
+    thread_pool_run(pool, num_bands, 1, blur_band_range, &job);
+    return atomic_load(&job.failed) ? -1 : 0;
+}
+
+// ✅ 기본 파라미터
+void params_default(Params *params) {
+    params->corner_type = CORNER_SADDLE;
+    params->blur = BLUR_EXACT;
+    params->blur_tol = 0.05;  // r = 4 에서 랭크 2 (출력 오차 <= 0.041 * max|입력|)
+    params->max_iteration = 5;
+    params->eps = 0.01;
+    params->pool = NULL;
+    params->detect_threshold = 0.1;
+    params->nms_radius = R;
+    params->pyramid_levels = 0;
+    params->phase_lut = 0;
+    params->recenter_max = 0.0;
+    params->cascade = 0;
+    params->stats = NULL;
+}
+
+// ✅ 계측 초기화
+void fit_stats_reset(fit_stats *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+// ✅ src 의 계측을 dst 에 더함 (작업을 나눠 따로 기록한 계측 합치기)
+void fit_stats_add(fit_stats *dst, const fit_stats *src) {
+    dst->detect_ns += src->detect_ns;
+    dst->blur_ns += src->blur_ns;
+    dst->newton_ns += src->newton_ns;
+    dst->dedup_ns += src->dedup_ns;
+    dst->candidates += src->candidates;
+    dst->converged += src->converged;
+    dst->rejected_border += src->rejected_border;
+    dst->rejected_det += src->rejected_det;
+    dst->rejected_not_converged += src->rejected_not_converged;
+    dst->rejected_signs += src->rejected_signs;
+    dst->iterations += src->iterations;
+    dst->resamples_saved += src->resamples_saved;
+    dst->duplicates += src->duplicates;
+    dst->lazy_tiles += src->lazy_tiles;
+}
+
+// ✅ 피팅한 코너당 평균 뉴턴 반복 횟수
+double fit_stats_mean_iterations(const fit_stats *stats) {
+    return stats->candidates > 0 ? (double)stats->iterations / stats->candidates : 0.0;
+}
+
+// ✅ 계측을 JSON 한 줄로 출력 (시간은 밀리초, 성공 시 0)
+int fit_stats_write_json(const fit_stats *stats, FILE *out) {
+    int n = fprintf(out,
+                    "{\"detect_ms\":%.3f,\"blur_ms\":%.3f,\"newton_ms\":%.3f,\"dedup_ms\":%.3f,"
+                    "\"candidates\":%ld,\"converged\":%ld,\"rejected_border\":%ld,\"rejected_det\":%ld,"
+                    "\"rejected_not_converged\":%ld,\"rejected_signs\":%ld,\"duplicates\":%ld,\"lazy_tiles\":%ld,\"resamples_saved\":%ld,"
+                    "\"mean_iterations\":%.3f}\n",
+                    stats->detect_ns * 1e-6, stats->blur_ns * 1e-6, stats->newton_ns * 1e-6, stats->dedup_ns * 1e-6,
+                    stats->candidates, stats->converged, stats->rejected_border, stats->rejected_det,
+                    stats->rejected_not_converged, stats->rejected_signs, stats->duplicates, stats->lazy_tiles,
+                    stats->resamples_saved, fit_stats_mean_iterations(stats));
+    return n < 0 ? -1 : 0;
+}
+
+// ✅ 파라미터에 따라 원뿔 블러 적용 (성공 시 0)
+int apply_blur(const image_source *img, const double *kernel, int r, const Params *params, image_view *output) {
+    if (params->blur == BLUR_SEPARABLE) {
+        return apply_convolution_separable(img, r, params->blur_tol, output, NULL) > 0 ? 0 : -1;
+    }
+    if (params->blur == BLUR_SIMD_F32) {
+        return apply_convolution_via_f32(img, kernel, r, output);
+    }
+    // BLUR_LAZY 도 전체 이미지가 필요하면 직접 컨볼루션
+    apply_convolution_tiled(img, kernel, r, output, params->pool, 0);
+    return 0;
+}
+
+// ✅ 블록 행렬 곱 K(terms x FIT_BATCH) = W(terms x N) * P(N x FIT_BATCH)
+// P의 한 행을 읽어 모든 항에 누적하므로 안쪽 루프가 코너 방향으로 연속 (벡터화)
+static void multiply_operator_patches(const double *W, int terms, int N, const double *P, double *K) {
+    memset(K, 0, (size_t)terms * FIT_BATCH * sizeof(double));
+    for (int n = 0; n < N; n++) {
+        const double *p = P + (size_t)n * FIT_BATCH;
+        for (int t = 0; t < terms; t++) {
+            double wn = W[(size_t)t * N + n];
+            double *k = K + (size_t)t * FIT_BATCH;
+            for (int b = 0; b < FIT_BATCH; b++) {
+                k[b] += wn * p[b];
+            }
+        }
+    }
+}
+
+// ✅ 마스크 안쪽 샘플의 선형 오프셋 (dy * stride + dx) 계산
+static void patch_offsets(const fit_operator *op, int stride, ptrdiff_t *offsets) {
+    int size = 2 * op->r + 1;
+    int n = 0;
+    for (int j = -op->r; j <= op->r; j++) {
+        for (int i = -op->r; i <= op->r; i++) {
+            if (op->mask[(j + op->r) * size + i + op->r] >= 1e-6) {
+                offsets[n++] = (ptrdiff_t)j * stride + i;
+            }
+        }
+    }
+}
+
+// ✅ 여러 코너의 다항식 계수를 한 번에 계산, 임의 반경용 (k: count x terms 행 우선)
+static void fit_coefficients_batch_generic(const image_view *img, const fit_operator *op,
+                                           const point2d *pts, int count, double *k) {
+    double P[MAX_PATCH_SIZE * FIT_BATCH];
+    double K[MAX_TERMS * FIT_BATCH];
+    ptrdiff_t offsets[MAX_PATCH_SIZE];
+    int N = op->num_valid;
+    ptrdiff_t s = img->stride;
+
+    patch_offsets(op, img->stride, offsets);
+
+    for (int start = 0; start < count; start += FIT_BATCH) {
+        int B = (count - start < FIT_BATCH) ? count - start : FIT_BATCH;
+
+        // 패치를 열 단위로 모음: P[n][b] (bilinear interpolation)
+        for (int b = 0; b < B; b++) {
+            double u = pts[start + b].x, v = pts[start + b].y;
+            int iu = (int)u, iv = (int)v;
+            double du = u - iu, dv = v - iv;
+            double a00 = 1 - du - dv + du * dv;
+            double a01 = du - du * dv;
+            double a10 = dv - du * dv;
+            double a11 = du * dv;
+            const double *base = &PIXEL(img, iu, iv);
+
+            for (int n = 0; n < N; n++) {
+                const double *q = base + offsets[n];
+                P[n * FIT_BATCH + b] = a00 * q[0] + a01 * q[1] + a10 * q[s] + a11 * q[s + 1];
+            }
+        }
+        for (int b = B; b < FIT_BATCH; b++) {
+            for (int n = 0; n < N; n++) {
+                P[n * FIT_BATCH + b] = 0.0;
+            }
+        }
+
+        multiply_operator_patches(op->invAtAAt, op->terms, N, P, K);
+
+        for (int b = 0; b < B; b++) {
+            for (int t = 0; t < op->terms; t++) {
+                k[(size_t)(start + b) * op->terms + t] = K[(size_t)t * FIT_BATCH + b];
+            }
+        }
+    }
+}
+
+// ✅ 반경 r, 항 수 terms 가 상수로 들어오는 일괄 피팅 본체
+// 래퍼에서 상수로 인라인되면 패치/행렬 곱 루프 경계가 모두 고정되어 펼쳐짐
+// 마스크 대신 정사각 패치 전체를 op->dense 로 곱함 (마스크 밖 가중치 0)
+static inline __attribute__((always_inline))
+void fit_batch_fixed(const image_view *img, const fit_operator *op, const point2d *pts, int count,
+                     double *k, const int r, const int terms, double *P, double *K) {
+    const int size = 2 * r + 1;
+    const int N = size * size;
+    ptrdiff_t s = img->stride;
+
+    for (int start = 0; start < count; start += FIT_BATCH) {
+        int B = (count - start < FIT_BATCH) ? count - start : FIT_BATCH;
+
+        for (int b = 0; b < B; b++) {
+            double u = pts[start + b].x, v = pts[start + b].y;
+            int iu = (int)u, iv = (int)v;
+            double du = u - iu, dv = v - iv;
+            double a00 = 1 - du - dv + du * dv;
+            double a01 = du - du * dv;
+            double a10 = dv - du * dv;
+            double a11 = du * dv;
+
+            for (int j = 0; j < size; j++) {
+                const double *q = &PIXEL(img, iu - r, iv - r + j);
+                double *p = P + (size_t)j * size * FIT_BATCH + b;
+                for (int i = 0; i < size; i++) {
+                    p[i * FIT_BATCH] = a00 * q[i] + a01 * q[i + 1] + a10 * q[i + s] + a11 * q[i + s + 1];
+                }
+            }
+        }
+        for (int b = B; b < FIT_BATCH; b++) {
+            for (int n = 0; n < N; n++) {
+                P[n * FIT_BATCH + b] = 0.0;
+            }
+        }
+
+        multiply_operator_patches(op->dense, terms, N, P, K);
+
+        for (int b = 0; b < B; b++) {
+            for (int t = 0; t < terms; t++) {
+                k[(size_t)(start + b) * terms + t] = K[(size_t)t * FIT_BATCH + b];
+            }
+        }
+    }
+}
+
+typedef void (*fit_batch_fn)(const image_view *, const fit_operator *, const point2d *, int, double *);
+
+// 반경/차수별로 스택 버퍼 크기가 고정된 래퍼 생성
+#define DEFINE_FIT_BATCH(RADIUS, ORDER, TERMS)                                                  \
+    static void fit_batch_r##RADIUS##_o##ORDER(const image_view *img, const fit_operator *op,  \
+                                               const point2d *pts, int count, double *k) {     \
+        double P[(2 * RADIUS + 1) * (2 * RADIUS + 1) * FIT_BATCH];                             \
+        double K[TERMS * FIT_BATCH];                                                           \
+        fit_batch_fixed(img, op, pts, count, k, RADIUS, TERMS, P, K);                          \
+    }
+#define DEFINE_FIT_BATCH_RADIUS(RADIUS)                \
+    DEFINE_FIT_BATCH(RADIUS, 2, MATRIX_SIZE)           \
+    DEFINE_FIT_BATCH(RADIUS, 3, MONKEY_MATRIX_SIZE)
+
+DEFINE_FIT_BATCH_RADIUS(2)
+DEFINE_FIT_BATCH_RADIUS(3)
+DEFINE_FIT_BATCH_RADIUS(4)
+DEFINE_FIT_BATCH_RADIUS(5)
+DEFINE_FIT_BATCH_RADIUS(6)
+DEFINE_FIT_BATCH_RADIUS(7)
+DEFINE_FIT_BATCH(8, 3, MONKEY_MATRIX_SIZE)
+DEFINE_FIT_BATCH(9, 3, MONKEY_MATRIX_SIZE)
+DEFINE_FIT_BATCH(10, 3, MONKEY_MATRIX_SIZE)
+
+// [차수 - 2][반경], 비어 있으면 일반 경로
+// 2차 r >= 8 은 정사각 패치의 마스크 밖 샘플 비용이 커서 일반 경로가 더 빠름 (측정)
+static const fit_batch_fn fit_batch_table[2][MAX_R + 1] = {
+    {NULL, NULL, fit_batch_r2_o2, fit_batch_r3_o2, fit_batch_r4_o2, fit_batch_r5_o2,
+     fit_batch_r6_o2, fit_batch_r7_o2, NULL, NULL, NULL},
+    {NULL, NULL, fit_batch_r2_o3, fit_batch_r3_o3, fit_batch_r4_o3, fit_batch_r5_o3,
+     fit_batch_r6_o3, fit_batch_r7_o3, fit_batch_r8_o3, fit_batch_r9_o3, fit_batch_r10_o3},
+};
+
+// ✅ 여러 코너의 다항식 계수를 한 번에 계산 (k: count x terms 행 우선)
+// 반경 2..10 은 고정 크기 커널, 그 외는 일반 경로
+void fit_coefficients_batch(const image_view *img, const fit_operator *op,
+                            const point2d *pts, int count, double *k) {
+    fit_batch_fn fn = fit_batch_table[op->order - 2][op->r];
+    if (fn != NULL) {
+        fn(img, op, pts, count, k);
+    } else {
+        fit_coefficients_batch_generic(img, op, pts, count, k);
+    }
+}
+
+// ✅ 위상 표 피팅 본체: 원본 (2r+2)² 창을 연속 버퍼로 모은 뒤 항마다 가중치와 내적
+static inline __attribute__((always_inline))
+void phase_batch_body(const image_view *img, const double *phase, const point2d *pts, int count, double *k,
+                      const int r, const int terms) {
+    const int S = 2 * r + 2;
+    const size_t per_phase = (size_t)terms * S * S;
+    double win[(2 * MAX_R + 2) * (2 * MAX_R + 2)];
+    for (int b = 0; b < count; b++) {
+        int iu = (int)pts[b].x, iv = (int)pts[b].y;
+        int pu = (int)((pts[b].x - iu) * PHASE_STEPS), pv = (int)((pts[b].y - iv) * PHASE_STEPS);
+        const double *w = phase + (size_t)(pv * PHASE_STEPS + pu) * per_phase;
+        for (int j = 0; j < S; j++) {
+            memcpy(win + j * S, &PIXEL(img, iu - r, iv - r + j), (size_t)S * sizeof(double));
+        }
+        for (int t = 0; t < terms; t++) {
+            const double *wt = w + (size_t)t * S * S;
+            double sum = 0.0;
+            for (int i = 0; i < S * S; i++) {
+                sum += wt[i] * win[i];
+            }
+            k[(size_t)b * terms + t] = sum;
+        }
+    }
+}
+
+// ✅ 위상 표로 계수 계산 (pts 는 phase_snap 된 위치, 보간 없이 원본 창과 가중치의 내적만)
+// 기본 반경 R 은 창 크기가 상수인 본체로
+void fit_coefficients_batch_phase(const image_view *img, const fit_operator *op, const double *phase,
+                                  const point2d *pts, int count, double *k) {
+    if (op->r == R && op->terms == MATRIX_SIZE) {
+        phase_batch_body(img, phase, pts, count, k, R, MATRIX_SIZE);
+    } else if (op->r == R && op->terms == MONKEY_MATRIX_SIZE) {
+        phase_batch_body(img, phase, pts, count, k, R, MONKEY_MATRIX_SIZE);
+    } else {
+        phase_batch_body(img, phase, pts, count, k, op->r, op->terms);
+    }
+}
+
+// 밴드별 후보 목록
+typedef struct {
+    point2d *p;
+    double *score;
+    int size;
+    int capacity;
+} candidate_list;
+
+#define DETECT_MARGIN (2 * R + 2)  // 원본 해상도 검출 여백: 블러 테두리 R + 피팅 패치 R + 보간/차분 여유
+#define COARSE_MARGIN (R + 1)      // 피라미드 거친 단계 검출 여백: 블러 테두리 R + 응답 차분 1 픽셀
+
+// 후보 검출 작업 컨텍스트
+typedef struct {
+    int band_rows;
+    int margin;  // 이미지 가장자리에서 제외할 폭
+    int nms;
+    int width;
+    int height;
+    candidate_list *bands;
+    const image_view *blurred;  // 미리 블러한 이미지 (detect_candidates_blurred)
+    arena *arena;               // 후보 목록을 받은 호출 스레드 아레나
+    arena_mark mark;
+    atomic_int failed;
+} detect_job;
+
+// ✅ 블러 이미지의 안장 응답 S = Ixy² - Ixx·Iyy (헤시안 행렬식의 음수, 안장점에서 양수)
+static inline double saddle_response(const double *p, ptrdiff_t s) {
+    double ixx = p[-1] - 2 * p[0] + p[1];
+    double iyy = p[-s] - 2 * p[0] + p[s];
+    double ixy = 0.25 * (p[s + 1] - p[s - 1] - p[-s + 1] + p[-s - 1]);
+    return ixy * ixy - ixx * iyy;
+}
+
+// ✅ 한 밴드의 응답 계산 + 비최대 억제 (band 는 nms + 1 행 halo 포함)
+static void detect_band(void *ctx, const image_view *band, int band_y0, int y0, int y1) {
+    detect_job *job = ctx;
+    candidate_list *list = &job->bands[y0 / job->band_rows];
+    int W = job->width, nms = job->nms;
+    int lo = job->margin, hi_x = W - job->margin, hi_y = job->height - job->margin;
+
+    // 응답은 후보 행 ± nms 범위에서만 필요
+    int ry0 = (y0 - nms > lo) ? y0 - nms : lo;
+    int ry1 = (y1 + nms < hi_y) ? y1 + nms : hi_y;
+    if (ry1 <= ry0) {
+        return;
+    }
+    arena *a = thread_arena();
+    if (a == NULL) {
+        atomic_store(&job->failed, 1);
+        return;
+    }
+    arena_mark mark = arena_get_mark(a);
+    double *resp = arena_alloc(a, (size_t)(ry1 - ry0) * W * sizeof(double));
+    if (resp == NULL) {
+        atomic_store(&job->failed, 1);
+        return;
+    }
+    for (int y = ry0; y < ry1; y++) {
+        double *out = resp + (size_t)(y - ry0) * W;
+        const double *row = &PIXEL(band, 0, y - band_y0);
+        for (int x = lo; x < hi_x; x++) {
+            out[x] = saddle_response(row + x, band->stride);
+        }
+    }
+
+    int cy0 = (y0 > lo) ? y0 : lo;
+    int cy1 = (y1 < hi_y) ? y1 : hi_y;
+    for (int y = cy0; y < cy1; y++) {
+        for (int x = lo; x < hi_x; x++) {
+            double s = resp[(size_t)(y - ry0) * W + x];
+            if (s <= 0) {
+                continue;
+            }
+            // 앞선 이웃보다 크고 뒤 이웃보다 작지 않을 때만 극대 (평탄한 구간은 첫 점만)
+            int is_max = 1;
+            for (int dy = -nms; dy <= nms && is_max; dy++) {
+                int yy = y + dy;
+                if (yy < ry0 || yy >= ry1) {
+                    continue;
+                }
+                const double *row = resp + (size_t)(yy - ry0) * W;
+                for (int dx = -nms; dx <= nms; dx++) {
+                    int xx = x + dx;
+                    if (xx < lo || xx >= hi_x || (dx == 0 && dy == 0)) {
+                        continue;
+                    }
+                    int before = (dy < 0) || (dy == 0 && dx < 0);
+                    if (row[xx] > s || (before && row[xx] == s)) {
+                        is_max = 0;
+                        break;
+                    }
+                }
+            }
+            if (!is_max) {
+                continue;
+            }
+
+            if (list->size == list->capacity) {
+                atomic_store(&job->failed, 1);  // detect_job_init 의 상한이 맞다면 일어나지 않음
+                break;
+            }
+            list->p[list->size].x = x;
+            list->p[list->size].y = y;
+            list->score[list->size] = s;
+            list->size++;
+        }
+    }
+    arena_release(a, mark);
+}
+
+// ✅ 검출 작업 준비 (밴드 수 반환, 실패 시 -1)
+// 극대점끼리는 체비셰프 거리가 nms + 1 이상이므로 밴드당 후보 수에 상한이 있어
+// 후보 목록을 호출 스레드 아레나에서 한 번에 잡고 밴드 작업 중에는 늘리지 않음
+static int detect_job_init(detect_job *job, int width, int height, int margin, const Params *params) {
+    job->margin = margin;
+    job->nms = params->nms_radius > 0 ? params->nms_radius : 1;
+    job->band_rows = choose_band_rows(width, R, job->nms + 1);
+    job->width = width;
+    job->height = height;
+    job->blurred = NULL;
+    job->arena = thread_arena();
+    atomic_init(&job->failed, 0);
+    if (job->arena == NULL) {
+        return -1;
+    }
+    job->mark = arena_get_mark(job->arena);
+
+    int num_bands = (height + job->band_rows - 1) / job->band_rows;
+    int step = job->nms + 1;
+    int capacity = ((width + step - 1) / step) * ((job->band_rows + step - 1) / step);
+    job->bands = arena_alloc(job->arena, (num_bands > 0 ? num_bands : 1) * sizeof(candidate_list));
+    for (int b = 0; b < num_bands && job->bands != NULL; b++) {
+        candidate_list *list = &job->bands[b];
+        list->p = arena_alloc(job->arena, (size_t)capacity * sizeof(point2d));
+        list->score = arena_alloc(job->arena, (size_t)capacity * sizeof(double));
+        list->size = 0;
+        list->capacity = capacity;
+        if (list->p == NULL || list->score == NULL) {
+            job->bands = NULL;
+        }
+    }
+    if (job->bands == NULL) {
+        arena_release(job->arena, job->mark);
+        return -1;
+    }
+    return num_bands;
+}
+
+// ✅ 밴드별 후보를 상대 임계값으로 걸러 corners 에 모으고 밴드 목록 해제 (성공 시 0)
+static int detect_job_finish(detect_job *job, int num_bands, Corner2 *corners, const Params *params, int status) {
+    if (atomic_load(&job->failed)) {
+        status = -1;
+    }
+
+    double max_score = 0;
+    for (int b = 0; b < num_bands; b++) {
+        for (int i = 0; i < job->bands[b].size; i++) {
+            if (job->bands[b].score[i] > max_score) {
+                max_score = job->bands[b].score[i];
+            }
+        }
+    }
+
+    corners->Size = 0;
+    double min_score = params->detect_threshold * max_score;
+    for (int b = 0; b < num_bands; b++) {
+        candidate_list *list = &job->bands[b];
+        for (int i = 0; i < list->size && status == 0; i++) {
+            if (list->score[i] < min_score) {
+                continue;
+            }
+            int n = corners_push(corners, list->p[i], R);
+            if (n < 0) {
+                status = -1;
+                break;
+            }
+            corners->Score[n] = list->score[i];
+        }
+    }
+    arena_release(job->arena, job->mark);
+    return status;
+}
+
+// ✅ 가장자리 margin 픽셀을 뺀 영역에서 후보 검출 (detect_candidates 본체, 성공 시 0)
+static int detect_candidates_margin(const image_source *img, Corner2 *corners, const Params *params, int margin) {
+    const fit_operator *op = get_fit_operator(R, 2);
+    Params defaults;
+    detect_job job;
+    if (params == NULL) {
+        params_default(&defaults);
+        params = &defaults;
+    }
+    if (op == NULL) {
+        return -1;
+    }
+
+    int num_bands = detect_job_init(&job, img->width, img->height, margin, params);
+    if (num_bands < 0) {
+        return -1;
+    }
+    int status = blur_bands_fused(img, op->mask, R, params->pool, job.band_rows, job.nms + 1,
+                                  detect_band, &job);
+    return detect_job_finish(&job, num_bands, corners, params, status);
+}
+
+// ✅ 후보 코너 검출: 원뿔 블러 → 안장 응답 → 비최대 억제 → 상대 임계값 (성공 시 0)
+// 블러와 검출은 밴드 단위로 결합되어 전체 블러 이미지를 만들지 않음, 결과는 행 우선 순서
+int detect_candidates(const image_source *img, Corner2 *corners, const Params *params) {
+    return detect_candidates_margin(img, corners, params, DETECT_MARGIN);
+}
+
+// ✅ 미리 블러한 이미지의 밴드 [begin, end) 검출
+static void detect_blurred_range(void *ctx, int begin, int end) {
+    detect_job *job = ctx;
+    for (int b = begin; b < end; b++) {
+        int y0 = b * job->band_rows;
+        int y1 = (y0 + job->band_rows < job->height) ? y0 + job->band_rows : job->height;
+        detect_band(job, job->blurred, 0, y0, y1);
+    }
+}
+
+// ✅ 반경 R 원뿔로 이미 블러한 이미지에서 후보 검출 (블러를 다른 단계에서 한 경우, 성공 시 0)
+int detect_candidates_blurred(const image_view *blur_img, Corner2 *corners, const Params *params) {
+    Params defaults;
+    detect_job job;
+    if (params == NULL) {
+        params_default(&defaults);
+        params = &defaults;
+    }
+
+    int num_bands = detect_job_init(&job, blur_img->width, blur_img->height, DETECT_MARGIN, params);
+    if (num_bands < 0) {
+        return -1;
+    }
+    job.blurred = blur_img;
+    thread_pool_run(params->pool, num_bands, 1, detect_blurred_range, &job);
+    return detect_job_finish(&job, num_bands, corners, params, 0);
+}
+
+// 이미지 피라미드 (0 단계는 원본 base, levels[0] 은 비어 있음)
+#define MAX_PYRAMID_LEVELS 6
+typedef struct {
+    image_source base;
+    image_view levels[MAX_PYRAMID_LEVELS + 1];
+    int num_levels;  // 원본 포함
+} image_pyramid;
+
+// ✅ l 단계 이미지를 원본 형태로 (0 단계는 원본 그대로)
+image_source pyramid_level(const image_pyramid *pyr, int l) {
+    return (l == 0) ? pyr->base : image_source_view(&pyr->levels[l]);
+}
+
+// 피라미드 축소 작업 컨텍스트
+typedef struct {
+    const image_source *src;
+    image_view *dst;
+    double kernel[9];
+} downsample_job;
+
+// ✅ 출력 행 [begin, end): 원뿔 블러(r = 1)를 짝수 위치에서만 계산 (가장자리는 복제)
+static void downsample_rows(void *ctx, int begin, int end) {
+    const downsample_job *job = ctx;
+    const image_source *src = job->src;
+    for (int y = begin; y < end; y++) {
+        for (int x = 0; x < job->dst->width; x++) {
+            double sum = 0.0;
+            for (int ky = -1; ky <= 1; ky++) {
+                int sy = 2 * y + ky;
+                sy = sy < 0 ? 0 : (sy >= src->height ? src->height - 1 : sy);
+                for (int kx = -1; kx <= 1; kx++) {
+                    int sx = 2 * x + kx;
+                    sx = sx < 0 ? 0 : (sx >= src->width ? src->width - 1 : sx);
+                    sum += job->kernel[(ky + 1) * 3 + kx + 1] * source_at(src, sx, sy);
+                }
+            }
+            PIXEL(job->dst, x, y) = sum;
+        }
+    }
+}
+
+// ✅ 1/2 축소 (원뿔 블러 후 짝수 픽셀 선택, 성공 시 0)
+int pyramid_downsample(const image_source *src, image_view *dst, thread_pool *pool) {
+    if (image_create(dst, (src->width + 1) / 2, (src->height + 1) / 2) != 0) {
+        return -1;
+    }
+    downsample_job job;
+    job.src = src;
+    job.dst = dst;
+    create_cone_filter_kernel(job.kernel, 1);
+    thread_pool_run(pool, dst->height, 16, downsample_rows, &job);
+    return 0;
+}
+
+// ✅ 피라미드 생성 (가장 작은 단계가 검출 여백보다 작아지면 멈춤, 성공 시 0)
+int pyramid_build(const image_source *img, int levels, image_pyramid *pyr, thread_pool *pool) {
+    if (levels > MAX_PYRAMID_LEVELS) {
+        levels = MAX_PYRAMID_LEVELS;
+    }
+    memset(pyr, 0, sizeof(*pyr));
+    pyr->base = *img;
+    pyr->num_levels = 1;
+    for (int l = 1; l <= levels; l++) {
+        image_source prev = pyramid_level(pyr, l - 1);
+        if (prev.width / 2 < 8 * R || prev.height / 2 < 8 * R) {
+            break;
+        }
+        if (pyramid_downsample(&prev, &pyr->levels[l], pool) != 0) {
+            return -1;
+        }
+        pyr->num_levels++;
+    }
+    return 0;
+}
+
+// ✅ 피라미드 해제 (원본 단계는 건드리지 않음)
+void pyramid_free(image_pyramid *pyr) {
+    for (int l = 1; l < pyr->num_levels; l++) {
+        image_destroy(&pyr->levels[l]);
+    }
+    pyr->num_levels = 0;
+}
+
+// ✅ p 주변 ±search 픽셀에서 안장 응답이 가장 큰 정수 위치로 이동 (블러는 필요한 창에서만 계산)
+// 옮긴 위치의 응답 반환 (창이 이미지를 벗어나 그대로 두면 0)
+static double refine_seed_local(const image_source *img, const double *kernel, int r, int search, point2d *p) {
+    enum { MAX_SEARCH = 4, WIN = 2 * MAX_SEARCH + 3 };
+    double blur[WIN][WIN];
+    int size = 2 * r + 1;
+    int cx = (int)floor(p->x + 0.5), cy = (int)floor(p->y + 0.5);
+    int h = search + 1;  // 응답 계산에 한 픽셀 여유 필요
+
+    if (search > MAX_SEARCH) {
+        search = MAX_SEARCH;
+        h = search + 1;
+    }
+    if (cx - h - r < 0 || cx + h + r >= img->width || cy - h - r < 0 || cy + h + r >= img->height) {
+        return 0.0;
+    }
+
+    for (int j = -h; j <= h; j++) {
+        for (int i = -h; i <= h; i++) {
+            double sum = 0.0;
+            for (int ky = -r; ky <= r; ky++) {
+                const double *k = kernel + (ky + r) * size + r;
+                for (int kx = -r; kx <= r; kx++) {
+                    sum += source_at(img, cx + i + kx, cy + j + ky) * k[kx];
+                }
+            }
+            blur[j + h][i + h] = sum;
+        }
+    }
+
+    double best = -HUGE_VAL;
+    int bx = 0, by = 0;
+    for (int j = -search; j <= search; j++) {
+        for (int i = -search; i <= search; i++) {
+            double s = saddle_response(&blur[j + h][i + h], WIN);
+            if (s > best) {
+                best = s;
+                bx = i;
+                by = j;
+            }
+        }
+    }
+    p->x = cx + bx;
+    p->y = cy + by;
+    return best;
+}
+
+// ✅ 원본 해상도 띠 [x0, x1) x [y0, y1) 에서 후보 검출, 응답이 min_score 이상인 것만 corners 에 추가 (성공 시 0)
+// 띠 바깥 DETECT_MARGIN 픽셀까지 잘라 읽어 띠 안쪽 전체가 검출 영역이 되게 함
+static int detect_border_strip(const image_source *img, int x0, int y0, int x1, int y1,
+                               const Params *strip_params, Corner2 *strip, Corner2 *corners) {
+    if (x1 <= x0 || y1 <= y0) {
+        return 0;
+    }
+    int cx0 = x0 - DETECT_MARGIN, cy0 = y0 - DETECT_MARGIN;
+    image_source view = image_source_crop(img, cx0, cy0, x1 + DETECT_MARGIN, y1 + DETECT_MARGIN);
+    if (detect_candidates(&view, strip, strip_params) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < strip->Size; i++) {
+        point2d p = {strip->p[i].x + cx0, strip->p[i].y + cy0};
+        int n = corners_push(corners, p, R);
+        if (n < 0) {
+            return -1;
+        }
+        corners->Score[n] = strip->Score[i];
+    }
+    return 0;
+}
+
+// ✅ 거친 단계에서 후보를 찾고 원본 좌표로 옮김 (params->pyramid_levels <= 0 이면 원본에서 검출)
+// 한 단계씩 내려오며 주변 ±2 픽셀에서 응답 최대 위치로 다시 맞춤
+// 거친 단계는 COARSE_MARGIN 만 빼고 검출, 그래도 원본에서 DETECT_MARGIN 보다 넓게 빠지는 가장자리 띠
+// (2단계 이상) 는 원본 해상도에서 따로 검출하고, 띠의 상대 임계값은 원본 응답 기준 최대값으로 맞춤
+int detect_candidates_pyramid(const image_source *img, Corner2 *corners, const Params *params) {
+    if (params == NULL || params->pyramid_levels <= 0) {
+        return detect_candidates(img, corners, params);
+    }
+
+    image_pyramid pyr;
+    if (pyramid_build(img, params->pyramid_levels, &pyr, params->pool) != 0) {
+        pyramid_free(&pyr);
+        return -1;
+    }
+
+    const fit_operator *op = get_fit_operator(R, 2);
+    int top = pyr.num_levels - 1;
+    image_source coarse = pyramid_level(&pyr, top);
+    int status = (op != NULL) ? detect_candidates_margin(&coarse, corners, params, COARSE_MARGIN) : -1;
+    double max_score = 0.0;  // 원본 해상도 응답 기준
+    for (int l = top - 1; l >= 0 && status == 0; l--) {
+        image_source level = pyramid_level(&pyr, l);
+        for (int i = 0; i < corners->Size; i++) {
+            corners->p[i].x *= 2;
+            corners->p[i].y *= 2;
+            double s = refine_seed_local(&level, op->mask, R, 2, &corners->p[i]);
+            if (l == 0 && s > max_score) {
+                max_score = s;
+            }
+        }
+    }
+
+    // 거친 단계 검출 영역의 원본 좌표 [lo_x, hi_x) x [lo_y, hi_y)
+    // 거친 단계가 2 * COARSE_MARGIN 이하면 검출 영역이 비므로 위아래 띠가 원본 전체를 덮게 가운데에서 나눔
+    int W = img->width, H = img->height, scale = 1 << top;
+    int lo_x = W / 2, hi_x = W / 2, lo_y = H / 2, hi_y = H / 2;
+    if (coarse.width > 2 * COARSE_MARGIN && coarse.height > 2 * COARSE_MARGIN) {
+        lo_x = COARSE_MARGIN * scale;
+        hi_x = (coarse.width - COARSE_MARGIN) * scale;
+        lo_y = COARSE_MARGIN * scale;
+        hi_y = (coarse.height - COARSE_MARGIN) * scale;
+    }
+    if (status == 0 && top > 0 && (lo_x > DETECT_MARGIN || lo_y > DETECT_MARGIN ||
+                                   hi_x < W - DETECT_MARGIN || hi_y < H - DETECT_MARGIN)) {
+        Params strip_params = *params;
+        Corner2 strips, strip;
+        int x0 = DETECT_MARGIN, x1 = W - DETECT_MARGIN, y0 = DETECT_MARGIN, y1 = H - DETECT_MARGIN;
+        lo_x = lo_x > x0 ? lo_x : x0;
+        lo_y = lo_y > y0 ? lo_y : y0;
+        hi_x = hi_x < x1 ? hi_x : x1;
+        hi_y = hi_y < y1 ? hi_y : y1;
+        strip_params.detect_threshold = 0.0;  // 임계값은 모든 띠와 거친 단계 후보를 합쳐 아래에서 적용
+        corners_init(&strips);
+        corners_init(&strip);
+        status = detect_border_strip(img, x0, y0, x1, lo_y, &strip_params, &strip, &strips);
+        if (status == 0) {
+            status = detect_border_strip(img, x0, hi_y, x1, y1, &strip_params, &strip, &strips);
+        }
+        if (status == 0) {
+            status = detect_border_strip(img, x0, lo_y, lo_x, hi_y, &strip_params, &strip, &strips);
+        }
+        if (status == 0) {
+            status = detect_border_strip(img, hi_x, lo_y, x1, hi_y, &strip_params, &strip, &strips);
+        }
+        for (int i = 0; i < strips.Size && status == 0; i++) {
+            if (strips.Score[i] > max_score) {
+                max_score = strips.Score[i];
+            }
+        }
+        for (int i = 0; i < strips.Size && status == 0; i++) {
+            if (strips.Score[i] < params->detect_threshold * max_score) {
+                continue;
+            }
+            int n = corners_push(corners, strips.p[i], R);
+            if (n < 0) {
+                status = -1;
+                break;
+            }
+            corners->Score[n] = strips.Score[i];
+        }
+        corners_free(&strip);
+        corners_free(&strips);
+    }
+
+    pyramid_free(&pyr);
+    return status;
+}
+
+// ✅ 뉴턴 상태 할당, 코너 위치로 시작 (성공 시 0)
+int refine_state_init(refine_state *st, const Corner2 *corners) {
+    int n = corners->Size > 0 ? corners->Size : 1;
+    st->pos = malloc(n * sizeof(point2d));
+    st->iterations = calloc(n, sizeof(int));
+    st->unconfirmed = calloc(n, sizeof(int));
+    st->residual = calloc(n, sizeof(double));
+    st->status = calloc(n, 1);
+    st->count = corners->Size;
+    if (!st->pos || !st->iterations || !st->unconfirmed || !st->residual || !st->status) {
+        free(st->pos);
+        free(st->iterations);
+        free(st->unconfirmed);
+        free(st->residual);
+        free(st->status);
+        memset(st, 0, sizeof(*st));
+        return -1;
+    }
+    if (corners->Size > 0) {
+        memcpy(st->pos, corners->p, corners->Size * sizeof(point2d));
+    }
+    return 0;
+}
+
+// ✅ 아레나에서 뉴턴 상태 할당, 코너 위치로 시작 (해제는 arena_release, 성공 시 0)
+int refine_state_init_arena(refine_state *st, const Corner2 *corners, arena *a) {
+    int n = corners->Size > 0 ? corners->Size : 1;
+    st->pos = arena_alloc(a, n * sizeof(point2d));
+    st->iterations = arena_alloc(a, n * sizeof(int));
+    st->unconfirmed = arena_alloc(a, n * sizeof(int));
+    st->residual = arena_alloc(a, n * sizeof(double));
+    st->status = arena_alloc(a, n);
+    st->count = corners->Size;
+    if (!st->pos || !st->iterations || !st->unconfirmed || !st->residual || !st->status) {
+        return -1;
+    }
+    memset(st->iterations, 0, n * sizeof(int));
+    memset(st->unconfirmed, 0, n * sizeof(int));
+    memset(st->residual, 0, n * sizeof(double));
+    memset(st->status, 0, n);
+    if (corners->Size > 0) {
+        memcpy(st->pos, corners->p, corners->Size * sizeof(point2d));
+    }
+    return 0;
+}
+
+// ✅ 뉴턴 상태 해제
+void refine_state_free(refine_state *st) {
+    free(st->pos);
+    free(st->iterations);
+    free(st->unconfirmed);
+    free(st->residual);
+    free(st->status);
+    memset(st, 0, sizeof(*st));
+}
+
+// ✅ 2차 피팅의 임계점까지 이동량 (안장점이 아니면 -1)
+static int saddle_step(const double *c, double *dx, double *dy) {
+    double det = 4 * c[0] * c[1] - c[2] * c[2];
+    if (!(det < 0)) {
+        return -1;
+    }
+    *dx = (c[2] * c[4] - 2 * c[1] * c[3]) / det;
+    *dy = (c[2] * c[3] - 2 * c[0] * c[4]) / det;
+    return 0;
+}
+
+// ✅ 3차 피팅에서 2차 미분이 모두 0이 되는 점까지 이동량 (monkey saddle이 아니면 -1)
+// c: x³, x²y, xy², y³, x², y², xy, x, y, 1
+static int monkey_saddle_step(const double *c, double *dx, double *dy) {
+    // 3차 항의 판별식 > 0 이면 세 방향의 능선/골짜기가 서로 다름
+    double a = c[0], b = c[1], e = c[2], d = c[3];
+    double disc = 18 * a * b * e * d - 4 * b * b * b * d + b * b * e * e
+                - 4 * a * e * e * e - 27 * a * a * d * d;
+    if (!(disc > 0)) {
+        return -1;
+    }
+
+    // f_xx = 0, f_xy = 0, f_yy = 0 세 식을 최소자승으로 풂
+    double M[3][2] = {{6 * a, 2 * b}, {2 * b, 2 * e}, {2 * e, 6 * d}};
+    double rhs[3] = {-2 * c[4], -c[6], -2 * c[5]};
+    double n00 = 0, n01 = 0, n11 = 0, g0 = 0, g1 = 0;
+    for (int i = 0; i < 3; i++) {
+        n00 += M[i][0] * M[i][0];
+        n01 += M[i][0] * M[i][1];
+        n11 += M[i][1] * M[i][1];
+        g0 += M[i][0] * rhs[i];
+        g1 += M[i][1] * rhs[i];
+    }
+    double det = n00 * n11 - n01 * n01;
+    if (!(det > 1e-12 * (n00 + n11) * (n00 + n11))) {
+        return -1;
+    }
+    *dx = (n11 * g0 - n01 * g1) / det;
+    *dy = (n00 * g1 - n01 * g0) / det;
+    return 0;
+}
+
+#define CASCADE_RING 16  // 조기 기각 1단계 둘레 샘플 수 (22.5도 간격)
+
+// ✅ 조기 기각 (통과하면 REFINE_ACTIVE, 아니면 REFINE_CASCADE_SIGNS), p 의 패치는 이미지 안쪽이어야 함
+// 반경 r 원 위 16점 (양선형) 에서 평균 대비 부호 교대 횟수, 안장점 4번 / monkey saddle 6번,
+// 시드가 어긋나면 보이는 칸이 줄어 monkey saddle 도 4번까지 내려가므로 둘 다 4번 미만만 버림
+// 패치 전체를 모으는 det 검사는 첫 뉴턴 반복과 같은 일이라 따로 두지 않음
+static int cascade_reject(const image_view *img, const fit_operator *op, point2d p) {
+    static const double ring[CASCADE_RING][2] = {
+        {1.0, 0.0}, {0.92387953, 0.38268343}, {0.70710678, 0.70710678}, {0.38268343, 0.92387953},
+        {0.0, 1.0}, {-0.38268343, 0.92387953}, {-0.70710678, 0.70710678}, {-0.92387953, 0.38268343},
+        {-1.0, 0.0}, {-0.92387953, -0.38268343}, {-0.70710678, -0.70710678}, {-0.38268343, -0.92387953},
+        {0.0, -1.0}, {0.38268343, -0.92387953}, {0.70710678, -0.70710678}, {0.92387953, -0.38268343},
+    };
+    int r = op->r;
+    double v[CASCADE_RING], mean = 0.0;
+    for (int n = 0; n < CASCADE_RING; n++) {
+        double u = p.x + r * ring[n][0], w = p.y + r * ring[n][1];
+        int iu = (int)u, iw = (int)w;
+        double du = u - iu, dw = w - iw;
+        const double *q = &PIXEL(img, iu, iw);
+        v[n] = (1 - dw) * ((1 - du) * q[0] + du * q[1]) + dw * ((1 - du) * q[img->stride] + du * q[img->stride + 1]);
+        mean += v[n];
+    }
+    mean /= CASCADE_RING;
+    int changes = 0;
+    for (int n = 0; n < CASCADE_RING; n++) {
+        changes += (v[n] > mean) != (v[(n + 1) % CASCADE_RING] > mean);
+    }
+    return (changes < 4) ? REFINE_CASCADE_SIGNS : REFINE_ACTIVE;
+}
+
+// 타일 상태 (지연 블러)
+enum { LAZY_EMPTY, LAZY_BUSY, LAZY_READY };
 
-        double b[PATCH_SIZE] = {0};
-        int num_valid;
-        get_image_patch_with_mask(img, mask, u_cur, v_cur, R, b, &num_valid);
+// 지연 블러: out 은 전체 크기지만 READY 타일만 유효한 값, 나머지는 건드리지 않음
+typedef struct {
+    image_source img;
+    const double *kernel;
+    int r;
+    image_view *out;
+    int tiles_x, tiles_y;
+    atomic_uchar *state;  // 타일별 LAZY_*
+    atomic_int computed;  // 계산한 타일 수
+} lazy_blur;
 
-        double k[MATRIX_SIZE];
-        multiply_matrix_vector(invAtAAt, b, k);
+// ✅ 지연 블러 준비 (타일 상태는 a 에서 받음, 성공 시 0)
+static int lazy_blur_init(lazy_blur *lb, const image_source *img, const double *kernel, int r,
+                          image_view *out, arena *a) {
+    lb->img = *img;
+    lb->kernel = kernel;
+    lb->r = r;
+    lb->out = out;
+    lb->tiles_x = (img->width + LAZY_TILE - 1) / LAZY_TILE;
+    lb->tiles_y = (img->height + LAZY_TILE - 1) / LAZY_TILE;
+    lb->state = arena_alloc(a, (size_t)lb->tiles_x * lb->tiles_y * sizeof(atomic_uchar) + 1);
+    if (lb->state == NULL) {
+        return -1;
+    }
+    for (int t = 0; t < lb->tiles_x * lb->tiles_y; t++) {
+        atomic_init(&lb->state[t], LAZY_EMPTY);
+    }
+    atomic_init(&lb->computed, 0);
+    return 0;
+}
 
-        double det = 4 * k[0] * k[1] - k[2] * k[2];
-        if (det > 0) {
-            is_saddle_point = 0;
-            break;
+// ✅ 영역 [x0, x1) x [y0, y1) 이 덮는 타일을 블러 (이미 된 타일은 건너뜀, 여러 스레드에서 호출 가능)
+// 다른 스레드가 계산 중인 타일은 끝날 때까지 기다림
+static void lazy_blur_ensure(lazy_blur *lb, int x0, int y0, int x1, int y1) {
+    int tx1 = (x1 - 1) / LAZY_TILE, ty1 = (y1 - 1) / LAZY_TILE;
+    for (int ty = y0 / LAZY_TILE; ty <= ty1; ty++) {
+        for (int tx = x0 / LAZY_TILE; tx <= tx1; tx++) {
+            atomic_uchar *state = &lb->state[ty * lb->tiles_x + tx];
+            if (atomic_load_explicit(state, memory_order_acquire) == LAZY_READY) {
+                continue;
+            }
+            unsigned char expected = LAZY_EMPTY;
+            if (atomic_compare_exchange_strong(state, &expected, LAZY_BUSY)) {
+                int bx = tx * LAZY_TILE, by = ty * LAZY_TILE;
+                int ex = (bx + LAZY_TILE < lb->img.width) ? bx + LAZY_TILE : lb->img.width;
+                int ey = (by + LAZY_TILE < lb->img.height) ? by + LAZY_TILE : lb->img.height;
+                convolve_rect(&lb->img, lb->kernel, lb->r, bx, ex, by, ey, &PIXEL(lb->out, 0, by), lb->out->stride);
+                atomic_fetch_add(&lb->computed, 1);
+                atomic_store_explicit(state, LAZY_READY, memory_order_release);
+                continue;
+            }
+            while (atomic_load_explicit(state, memory_order_acquire) != LAZY_READY) {
+                sched_yield();
+            }
+        }
+    }
+}
+
+// 뉴턴 반복 병렬 작업 컨텍스트
+typedef struct {
+    const image_view *blur_img;
+    lazy_blur *lazy;  // NULL 이 아니면 blur_img 는 패치가 닿을 때마다 채움
+    const double *phase;  // NULL 이 아니면 위상 표 피팅
+    const fit_operator *op;
+    refine_state *st;
+    const Params *params;
+} refine_job;
+
+// ✅ 코너 [begin, end) 뉴턴 반복 (결과는 코너별 슬롯에만 기록)
+// 한 번의 sweep은 아직 ACTIVE인 코너만 모아 일괄 피팅하므로, 수렴한 코너는 이후 비용이 없음
+static void refine_range(void *ctx, int begin, int end) {
+    const refine_job *job = ctx;
+    const image_view *blur_img = job->blur_img;
+    const fit_operator *op = job->op;
+    refine_state *st = job->st;
+    int active[REFINE_CHUNK];
+    point2d pts[REFINE_CHUNK];
+    double k[REFINE_CHUNK * MAX_TERMS];
+    int r = op->r;
+
+    for (int block = begin; block < end; block += REFINE_CHUNK) {
+        int block_end = (block + REFINE_CHUNK < end) ? block + REFINE_CHUNK : end;
+
+        int num_active = 0;
+        for (int i = block; i < block_end; i++) {
+            if (st->status[i] == REFINE_ACTIVE) {
+                active[num_active++] = i;
+            }
+        }
+
+        for (int num_it = 0; num_it < job->params->max_iteration && num_active > 0; num_it++) {
+            // 경계 검사 후 남은 코너의 위치를 모음
+            int n = 0;
+            for (int a = 0; a < num_active; a++) {
+                int i = active[a];
+                point2d p = (job->phase != NULL) ? phase_snap(st->pos[i]) : st->pos[i];
+                double u = p.x, v = p.y;
+                // 패치가 블러의 0 테두리 r 픽셀에 닿지 않아야 함 (response_row 의 margin = 2r 과 같은 기준)
+                // 안쪽 조건을 부정해서 검사 (NaN 위치는 비교가 모두 거짓이라 밖으로 처리됨)
+                if (!(u - 2 * r >= 0 && u + 2 * r + 1 < blur_img->width &&
+                      v - 2 * r >= 0 && v + 2 * r + 1 < blur_img->height)) {
+                    st->status[i] = REFINE_OUT_OF_BOUNDS;
+                    continue;
+                }
+                if (job->lazy != NULL) {
+                    // 양선형 보간 패치는 (iu - r, iv - r) 부터 2r + 2 칸
+                    int iu = (int)u, iv = (int)v;
+                    lazy_blur_ensure(job->lazy, iu - r, iv - r, iu + r + 2, iv + r + 2);
+                }
+                if (num_it == 0 && job->params->cascade) {
+                    int reject = cascade_reject(blur_img, op, p);
+                    if (reject != REFINE_ACTIVE) {
+                        st->status[i] = reject;
+                        continue;
+                    }
+                }
+                active[n] = i;
+                pts[n] = p;
+                n++;
+            }
+            num_active = n;
+
+            if (job->phase != NULL) {
+                fit_coefficients_batch_phase(blur_img, op, job->phase, pts, num_active, k);
+            } else {
+                fit_coefficients_batch(blur_img, op, pts, num_active, k);
+            }
+
+            n = 0;
+            for (int a = 0; a < num_active; a++) {
+                int i = active[a];
+                const double *c = k + (size_t)a * op->terms;
+                double dx, dy;
+                st->iterations[i]++;
+
+                int ok = (op->order == 3) ? monkey_saddle_step(c, &dx, &dy) : saddle_step(c, &dx, &dy);
+                if (ok != 0) {
+                    st->status[i] = REFINE_NOT_SADDLE;
+                    continue;
+                }
+
+                // 작은 이동이 같은 픽셀 칸 안이면 옮긴 자리에서 다시 피팅해 확인하지 않고 수렴으로 처리
+                // (옮긴 점에서 같은 다항식의 다음 이동은 항상 0 이라 확인 샘플링만 아끼고, 보간 편향은 남음)
+                double step2 = dx * dx + dy * dy, recenter_max = job->params->recenter_max;
+                if (recenter_max > 0 && job->phase == NULL && step2 > job->params->eps * job->params->eps &&
+                    step2 <= recenter_max * recenter_max &&
+                    floor(pts[a].x + dx) == floor(pts[a].x) && floor(pts[a].y + dy) == floor(pts[a].y)) {
+                    st->pos[i].x += dx;
+                    st->pos[i].y += dy;
+                    st->residual[i] = sqrt(step2);
+                    st->unconfirmed[i] = 1;
+                    st->status[i] = REFINE_CONVERGED;
+                    continue;
+                }
+
+                if (job->phase != NULL) {
+                    // 격자점 기준 이동이므로 수렴은 실제 위치 변화로 판정 (같은 격자점이면 0)
+                    dx += pts[a].x - st->pos[i].x;
+                    dy += pts[a].y - st->pos[i].y;
+                }
+                st->pos[i].x += dx;
+                st->pos[i].y += dy;
+                st->residual[i] = sqrt(dx * dx + dy * dy);
+
+                if (st->residual[i] <= job->params->eps) {
+                    st->status[i] = REFINE_CONVERGED;
+                    continue;
+                }
+                active[n++] = i;
+            }
+            num_active = n;
+        }
+
+        for (int a = 0; a < num_active; a++) {
+            st->status[active[a]] = REFINE_NOT_CONVERGED;
+        }
+    }
+}
+
+// ✅ 뉴턴 반복 (블러 이미지에서 매 반복 패치를 다시 샘플링, op 차수로 2차/3차 선택)
+// params->pool 이 있으면 코너 구간을 나눠 병렬 처리, 결과는 코너 순서와 무관하게 동일
+int refine_corners_newton(const image_view *blur_img, const fit_operator *op,
+                          refine_state *st, const Params *params) {
+    refine_job job = {blur_img, NULL, NULL, op, st, params};
+    if (params->phase_lut && (job.phase = get_phase_table(op)) == NULL) {
+        return -1;
+    }
+    thread_pool_run(params->pool, st->count, REFINE_CHUNK, refine_range, &job);
+    return 0;
+}
+
+// ✅ 지연 블러 위에서 뉴턴 반복 (lb->out 은 패치가 닿는 타일만 채워짐)
+static int refine_corners_newton_lazy(lazy_blur *lb, const fit_operator *op,
+                                      refine_state *st, const Params *params) {
+    refine_job job = {lb->out, lb, NULL, op, st, params};
+    if (params->phase_lut && (job.phase = get_phase_table(op)) == NULL) {
+        return -1;
+    }
+    thread_pool_run(params->pool, st->count, REFINE_CHUNK, refine_range, &job);
+    return 0;
+}
+
+// ✅ 코너의 피팅 반경 (Corner2::r 이 범위 밖이면 기본 R)
+static int corner_radius(const Corner2 *corners, int i) {
+    int r = corners->r[i];
+    return (r >= 1 && r <= MAX_R) ? r : R;
+}
+
+// ✅ 차수별 다항식 피팅 공통 경로 (반경별로 블러 → 뉴턴 반복 → 수렴한 코너만 남김)
+// 코너를 반경 순으로 정렬해 뉴턴 상태를 만들고, 같은 반경 구간마다 해당 연산자로 반복
+// blur_R 이 있으면 반경 R 코너는 다시 블러하지 않고 그 이미지를 사용
+// BLUR_LAZY 면 전체 블러 대신 뉴턴 반복 중 패치가 닿는 타일만 블러 (코너가 드물수록 이득)
+// 임시 버퍼(블러 이미지, 정렬 순서, 뉴턴 상태)는 스레드 아레나에서 받고 반환 전에 한 번에 되돌림
+static void polynomial_fit_order(const image_source *img, const image_view *blur_R,
+                                 Corner2* corners, const Params *params, int order) {
+    image_view blur_img;
+    refine_state st;
+    Params defaults;
+    int start[MAX_R + 2] = {0};
+    int *idx;
+    arena *a = thread_arena();
+    if (params == NULL) {
+        params_default(&defaults);
+        params = &defaults;
+    }
+    if (a == NULL) {
+        corners->Size = 0;
+        return;
+    }
+
+    arena_mark mark = arena_get_mark(a);
+    memset(&blur_img, 0, sizeof(blur_img));
+    idx = arena_alloc(a, (corners->Size > 0 ? corners->Size : 1) * sizeof(int));
+    if (idx == NULL || refine_state_init_arena(&st, corners, a) != 0) {
+        arena_release(a, mark);
+        corners->Size = 0;
+        return;
+    }
+
+    // 반경별 계수 정렬: 반경 r 코너는 정렬 순서 [start[r], start[r + 1])
+    for (int i = 0; i < corners->Size; i++) {
+        start[corner_radius(corners, i) + 1]++;
+    }
+    for (int r = 1; r <= MAX_R + 1; r++) {
+        start[r] += start[r - 1];
+    }
+    int fill[MAX_R + 1];
+    memcpy(fill, start, sizeof(fill));
+    for (int i = 0; i < corners->Size; i++) {
+        int s = fill[corner_radius(corners, i)]++;
+        idx[s] = i;
+        st.pos[s] = corners->p[i];
+    }
+
+    for (int r = 1; r <= MAX_R; r++) {
+        int n = start[r + 1] - start[r];
+        if (n == 0) {
+            continue;
+        }
+        refine_state group = {st.pos + start[r], st.iterations + start[r], st.unconfirmed + start[r],
+                              st.residual + start[r], st.status + start[r], n};
+        const fit_operator *op = get_fit_operator(r, order);
+        const image_view *blurred = (r == R) ? blur_R : NULL;
+
+        // 블러 커널과 마스크는 같은 원뿔 필터
+        int lazy = (params->blur == BLUR_LAZY && blurred == NULL);
+        if (op != NULL && blurred == NULL &&
+            (blur_img.data != NULL || image_create_arena(a, &blur_img, img->width, img->height) == 0)) {
+            STATS_CLOCK(t_blur);
+            if (lazy || apply_blur(img, op->mask, r, params, &blur_img) == 0) {
+                blurred = &blur_img;
+            }
+            STATS_ELAPSED(params, blur_ns, t_blur);
+        }
+        STATS_CLOCK(t_newton);
+        int status = -1;
+        if (op != NULL && blurred != NULL && !lazy) {
+            status = refine_corners_newton(blurred, op, &group, params);
+        } else if (op != NULL && blurred != NULL) {
+            // 타일 블러 시간은 뉴턴 반복 시간에 포함됨
+            lazy_blur lb;
+            if (lazy_blur_init(&lb, img, op->mask, r, &blur_img, a) == 0) {
+                status = refine_corners_newton_lazy(&lb, op, &group, params);
+                STATS_ADD(params, lazy_tiles, atomic_load(&lb.computed));
+            }
+        }
+        if (status != 0) {
+            memset(group.status, REFINE_NOT_CONVERGED, n);
+        }
+        STATS_ELAPSED(params, newton_ns, t_newton);
+    }
+
+#ifdef CALIB_STATS
+    if (params->stats != NULL) {
+        fit_stats *stats = params->stats;
+        stats->candidates += corners->Size;
+        for (int s = 0; s < corners->Size; s++) {
+            stats->iterations += st.iterations[s];
+            stats->resamples_saved += st.unconfirmed[s];
+            switch (st.status[s]) {
+            case REFINE_CONVERGED: stats->converged++; break;
+            case REFINE_OUT_OF_BOUNDS: stats->rejected_border++; break;
+            case REFINE_NOT_SADDLE: stats->rejected_det++; break;
+            case REFINE_CASCADE_SIGNS: stats->rejected_signs++; break;
+            default: stats->rejected_not_converged++; break;
+            }
+        }
+    }
+#endif
+
+    // 수렴한 코너만 정제된 위치로 남김 (원래 순서 유지)
+    unsigned char *choose = arena_alloc(a, corners->Size > 0 ? corners->Size : 1);
+    if (choose == NULL) {
+        corners->Size = 0;
+    } else {
+        for (int s = 0; s < corners->Size; s++) {
+            int i = idx[s];
+            choose[i] = (st.status[s] == REFINE_CONVERGED);
+            if (choose[i]) {
+                corners->p[i] = st.pos[s];
+            }
+        }
+        corners_compact(corners, choose);
+    }
+
+    arena_release(a, mark);
+}
+
+// ✅ Saddle Point 검출 (polynomial_fit_saddle)
+void polynomial_fit_saddle(const image_view *img, Corner2* corners, const Params *params) {
+    image_source src = image_source_view(img);
+    polynomial_fit_order(&src, NULL, corners, params, 2);
+}
+
+// ✅ Monkey Saddle Point 검출 (3차 피팅, deltille 타깃)
+void polynomial_fit_monkey_saddle(const image_view *img, Corner2* corners, const Params *params) {
+    image_source src = image_source_view(img);
+    polynomial_fit_order(&src, NULL, corners, params, 3);
+}
+
+// ✅ 8/16비트 원본에서 바로 피팅: params->corner_type 에 따라 2차/3차 선택
+void polynomial_fit_source(const image_source *img, Corner2* corners, const Params *params) {
+    int monkey = (params != NULL && params->corner_type == CORNER_MONKEY_SADDLE);
+    polynomial_fit_order(img, NULL, corners, params, monkey ? 3 : 2);
+}
+
+// ✅ 반경 R 블러를 이미 가진 경우의 피팅 (다른 반경 코너만 img 에서 다시 블러)
+void polynomial_fit_blurred(const image_source *img, const image_view *blur_img,
+                            Corner2* corners, const Params *params) {
+    int monkey = (params != NULL && params->corner_type == CORNER_MONKEY_SADDLE);
+    polynomial_fit_order(img, blur_img, corners, params, monkey ? 3 : 2);
+}
+
+// ✅ 실행 함수: params->corner_type 에 따라 2차/3차 피팅 선택
+void polynomial_fit(const image_view *img, Corner2* corners, const Params *params) {
+    image_source src = image_source_view(img);
+    polynomial_fit_source(&src, corners, params);
+}
+
+// ✅ 앞선 코너와 min_dist 이내로 겹치는 코너 제거 (순서 유지, 성공 시 0)
+int corners_remove_duplicates(Corner2 *corners, double min_dist) {
+    arena *a = thread_arena();
+    if (a == NULL) {
+        return -1;
+    }
+    arena_mark mark = arena_get_mark(a);
+    unsigned char *keep = arena_alloc(a, corners->Size > 0 ? corners->Size : 1);
+    if (keep == NULL) {
+        return -1;
+    }
+    double d2 = min_dist * min_dist;
+    for (int i = 0; i < corners->Size; i++) {
+        keep[i] = 1;
+        for (int j = 0; j < i; j++) {
+            double dx = corners->p[i].x - corners->p[j].x;
+            double dy = corners->p[i].y - corners->p[j].y;
+            if (keep[j] && dx * dx + dy * dy < d2) {
+                keep[i] = 0;
+                break;
+            }
+        }
+    }
+    corners_compact(corners, keep);
+    arena_release(a, mark);
+    return 0;
+}
+
+// ✅ 1 픽셀 이내 중복 제거 + 계측 (제거 시간과 제거한 코너 수)
+static int remove_duplicates_counted(Corner2 *corners, const Params *params) {
+    STATS_CLOCK(t_dedup);
+    int before = corners->Size;
+    int status = corners_remove_duplicates(corners, 1.0);
+    STATS_ADD(params, duplicates, before - corners->Size);
+    STATS_ELAPSED(params, dedup_ns, t_dedup);
+    return status;
+}
+
+// ✅ 후보 검출 후 원본 해상도에서 다항식 피팅 (같은 코너로 수렴한 후보는 하나만 남김, 성공 시 0)
+// 8/16비트 원본은 변환 복사본 없이 블러 단계에서 바로 읽음
+// 원본 해상도 검출이면 반경 R 블러를 한 번만 만들어 검출과 피팅이 같이 씀 (피라미드/BLUR_LAZY 는 피팅만 블러)
+int find_corners_source(const image_source *img, Corner2 *corners, const Params *params) {
+    Params defaults;
+    if (params == NULL) {
+        params_default(&defaults);
+        params = &defaults;
+    }
+    if (params->pyramid_levels > 0 || params->blur == BLUR_LAZY) {
+        STATS_CLOCK(t_detect);
+        if (detect_candidates_pyramid(img, corners, params) != 0) {
+            return -1;
+        }
+        STATS_ELAPSED(params, detect_ns, t_detect);
+        polynomial_fit_source(img, corners, params);
+        return remove_duplicates_counted(corners, params);
+    }
+
+    const fit_operator *op = get_fit_operator(R, 2);
+    arena *a = thread_arena();
+    image_view blur_img;
+    if (op == NULL || a == NULL) {
+        return -1;
+    }
+    arena_mark mark = arena_get_mark(a);
+    int status = image_create_arena(a, &blur_img, img->width, img->height);
+    if (status == 0) {
+        STATS_CLOCK(t_blur);
+        status = apply_blur(img, op->mask, R, params, &blur_img);
+        STATS_ELAPSED(params, blur_ns, t_blur);
+    }
+    if (status == 0) {
+        STATS_CLOCK(t_detect);
+        status = detect_candidates_blurred(&blur_img, corners, params);
+        STATS_ELAPSED(params, detect_ns, t_detect);
+    }
+    if (status == 0) {
+        polynomial_fit_blurred(img, &blur_img, corners, params);
+        status = remove_duplicates_counted(corners, params);
+    }
+    arena_release(a, mark);
+    return status;
+}
+
+// ✅ double 이미지용 find_corners
+int find_corners(const image_view *img, Corner2 *corners, const Params *params) {
+    image_source src = image_source_view(img);
+    return find_corners_source(&src, corners, params);
+}
+
+#define RESPONSE_BLOCK 4  // 계수 맵: 레지스터에 모든 항의 누적을 들고 가는 픽셀 수
+#define SADDLE_BANK_TERMS 5  // 2차 필터 뱅크 항: x², y², xy, x, y (det 와 임계점에 상수항은 안 씀)
+#define MONKEY_BANK_TERMS 7  // 3차 필터 뱅크 항: 3차 4개 + x², y², xy (판별식과 2차 미분 0 점)
+
+// 픽셀 RESPONSE_BLOCK 개의 계수 (taps: 마스크 안쪽 탭 오프셋, weights: 탭 우선 terms 개씩)
+typedef void (*response_block_fn)(const double *center, const ptrdiff_t *taps, const double *weights,
+                                  int num_taps, int terms, double c[][RESPONSE_BLOCK]);
+
+// ✅ 계수 블록 본체: 탭마다 입력을 한 번 읽어 모든 항에 누적
+static inline __attribute__((always_inline))
+void response_block_body(const double *center, const ptrdiff_t *taps, const double *weights, int num_taps,
+                         const int terms, double c[][RESPONSE_BLOCK]) {
+    double acc[MAX_TERMS][RESPONSE_BLOCK] = {{0}};
+    for (int n = 0; n < num_taps; n++) {
+        const double *in = center + taps[n];
+        const double *w = weights + (size_t)n * terms;
+        for (int t = 0; t < terms; t++) {
+            for (int l = 0; l < RESPONSE_BLOCK; l++) {
+                acc[t][l] += w[t] * in[l];
+            }
+        }
+    }
+    memcpy(c, acc, sizeof(double) * terms * RESPONSE_BLOCK);
+}
+
+// ✅ 계수 블록 (스칼라)
+static void response_block_scalar(const double *center, const ptrdiff_t *taps, const double *weights,
+                                  int num_taps, int terms, double c[][RESPONSE_BLOCK]) {
+    if (terms == SADDLE_BANK_TERMS) {
+        response_block_body(center, taps, weights, num_taps, SADDLE_BANK_TERMS, c);
+    } else {
+        response_block_body(center, taps, weights, num_taps, MONKEY_BANK_TERMS, c);
+    }
+}
+
+#ifdef CALIB_X86
+// ✅ 계수 블록 본체 (AVX2 + FMA, 항마다 4픽셀 누적 레지스터 하나)
+__attribute__((target("avx2,fma"))) static inline __attribute__((always_inline))
+void response_block_avx2_body(const double *center, const ptrdiff_t *taps, const double *weights, int num_taps,
+                              const int terms, double c[][RESPONSE_BLOCK]) {
+    __m256d acc[MAX_TERMS];
+#pragma GCC unroll 10
+    for (int t = 0; t < terms; t++) {
+        acc[t] = _mm256_setzero_pd();
+    }
+    for (int n = 0; n < num_taps; n++) {
+        __m256d v = _mm256_loadu_pd(center + taps[n]);
+        const double *w = weights + (size_t)n * terms;
+#pragma GCC unroll 10
+        for (int t = 0; t < terms; t++) {
+            acc[t] = _mm256_fmadd_pd(v, _mm256_broadcast_sd(w + t), acc[t]);
+        }
+    }
+#pragma GCC unroll 10
+    for (int t = 0; t < terms; t++) {
+        _mm256_storeu_pd(c[t], acc[t]);
+    }
+}
+
+// ✅ 계수 블록 (AVX2 + FMA)
+__attribute__((target("avx2,fma")))
+static void response_block_avx2(const double *center, const ptrdiff_t *taps, const double *weights,
+                                int num_taps, int terms, double c[][RESPONSE_BLOCK]) {
+    if (terms == SADDLE_BANK_TERMS) {
+        response_block_avx2_body(center, taps, weights, num_taps, SADDLE_BANK_TERMS, c);
+    } else {
+        response_block_avx2_body(center, taps, weights, num_taps, MONKEY_BANK_TERMS, c);
+    }
+}
+#endif
+
+// ✅ CPU 기능에 맞는 계수 블록 선택 (작업 시작 전 호출 스레드에서 한 번)
+static response_block_fn select_response_block(void) {
+    response_block_fn fn = response_block_scalar;
+#ifdef CALIB_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        fn = response_block_avx2;
+    }
+#endif
+    return fn;
+}
+
+// ✅ 계수로 det 와 임계점 이동량 기록 (det: 2차 4·k0·k1 - k2², 3차 -판별식, 음수면 안장점/monkey saddle 형태)
+static inline void response_store(const fit_operator *op, const double *c, double *det, double *dx, double *dy) {
+    double ox = 0.0, oy = 0.0;
+    int ok;
+    if (op->order == 3) {
+        double a = c[0], b = c[1], e = c[2], d = c[3];
+        *det = -(18 * a * b * e * d - 4 * b * b * b * d + b * b * e * e - 4 * a * e * e * e - 27 * a * a * d * d);
+        ok = monkey_saddle_step(c, &ox, &oy);
+    } else {
+        *det = 4 * c[0] * c[1] - c[2] * c[2];
+        ok = saddle_step(c, &ox, &oy);
+    }
+    *dx = (ok == 0) ? ox : 0.0;
+    *dy = (ok == 0) ? oy : 0.0;
+}
+
+// ✅ 블러 행 하나의 계수 → det 와 이동량 행 (열 [margin, W - margin) 만, margin = 2r: 블러 테두리 r + 패치 반경 r)
+// 마스크 안쪽 탭만 돌며, 픽셀 RESPONSE_BLOCK 개 x 뱅크 terms 항의 누적을 레지스터에 두고 입력 한 번 읽기를 모든 항이 공유
+static void response_row(const fit_operator *op, response_block_fn block, const ptrdiff_t *taps,
+                         const double *weights, int num_taps, int terms, const double *row, int W,
+                         double *det, double *dxs, double *dys) {
+    int margin = 2 * op->r;
+    double c[MAX_TERMS][RESPONSE_BLOCK];
+
+    int x = margin;
+    for (; x + RESPONSE_BLOCK <= W - margin; x += RESPONSE_BLOCK) {
+        block(row + x, taps, weights, num_taps, terms, c);
+        for (int l = 0; l < RESPONSE_BLOCK; l++) {
+            double cl[MAX_TERMS];
+            for (int t = 0; t < terms; t++) {
+                cl[t] = c[t][l];
+            }
+            response_store(op, cl, det + x + l, dxs + x + l, dys + x + l);
+        }
+    }
+    // 남은 열은 한 픽셀씩
+    for (; x < W - margin; x++) {
+        double cl[MAX_TERMS] = {0};
+        const double *center = row + x;
+        for (int n = 0; n < num_taps; n++) {
+            for (int t = 0; t < terms; t++) {
+                cl[t] += weights[n * terms + t] * center[taps[n]];
+            }
+        }
+        response_store(op, cl, det + x, dxs + x, dys + x);
+    }
+}
+
+#define DENSE_HALO (3 * R)  // 밴드 halo: 응답 r + 밴드 안 뉴턴 경계 검사 2r (밴드 가장자리 밖으로 r 픽셀까지 이동 허용)
+
+// 조밀 검출 작업 컨텍스트 (밴드 b 의 결과는 bands[b] 에만 기록)
+typedef struct {
+    const image_source *img;
+    const fit_operator *op;
+    const Params *params;
+    response_block_fn block;  // 풀 시작 전에 한 번 고른 계수 블록 함수
+    int terms;                // 뱅크 항 수 (SADDLE_BANK_TERMS / MONKEY_BANK_TERMS)
+    int num_taps;
+    int tap_index[MAX_PATCH_SIZE];  // 마스크 안쪽 탭의 (2r+1)² 패치 안 위치
+    double weights[MAX_PATCH_SIZE * MAX_TERMS];  // 탭 우선 (탭 n 의 뱅크 항 t: weights[n * terms + t])
+    int band_rows;
+    Corner2 *bands;         // 밴드별 정제된 코너 (원본 좌표, Score = -det)
+    double *band_max;       // 밴드별 최대 응답 -det
+    fit_stats *band_stats;  // 밴드별 계측 (NULL 이면 기록 안 함)
+    atomic_int failed;
+} dense_job;
+
+// ✅ 블러 밴드 하나: 계수 필터 뱅크로 행마다 후보 추출 → 밴드 안에서 뉴턴 반복
+// 전역 최대 응답은 모든 밴드가 끝나야 알 수 있으므로 밴드 최대 기준 임계값으로 먼저 거름 (전역 기준의 상위 집합)
+static void dense_band(void *ctx, const image_view *band, int band_y0, int y0, int y1) {
+    dense_job *job = ctx;
+    const fit_operator *op = job->op;
+    int b = y0 / job->band_rows;
+    Corner2 *list = &job->bands[b];
+    fit_stats *stats = (job->band_stats != NULL) ? &job->band_stats[b] : NULL;
+    int r = op->r, size = 2 * r + 1, margin = 2 * r;
+    int W = band->width, H = job->img->height;
+    ptrdiff_t taps[MAX_PATCH_SIZE];
+    for (int n = 0; n < job->num_taps; n++) {
+        int p = job->tap_index[n];
+        taps[n] = (ptrdiff_t)(p / size - r) * band->stride + (p % size - r);
+    }
+
+    arena *a = thread_arena();
+    if (a == NULL) {
+        atomic_store(&job->failed, 1);
+        return;
+    }
+    arena_mark mark = arena_get_mark(a);
+    double *det = arena_alloc(a, (size_t)3 * W * sizeof(double));
+    if (det == NULL) {
+        atomic_store(&job->failed, 1);
+        return;
+    }
+    double *dxs = det + W, *dys = det + 2 * W;
+
+    Params band_params = *job->params;
+    band_params.pool = NULL;  // 풀 작업 안에서 다시 풀을 쓰지 않음
+    band_params.stats = stats;
+    STATS_CLOCK(t_detect);
+    double band_max = 0.0;
+    int ys = (y0 > margin) ? y0 : margin, ye = (y1 < H - margin) ? y1 : H - margin;
+    for (int y = ys; y < ye; y++) {
+        response_row(op, job->block, taps, job->weights, job->num_taps, job->terms,
+                     &PIXEL(band, 0, y - band_y0), W, det, dxs, dys);
+        for (int x = margin; x < W - margin; x++) {
+            double s = -det[x], ox = dxs[x], oy = dys[x];
+            band_max = (s > band_max) ? s : band_max;
+            if (s <= 0 || ox < -0.5 || ox >= 0.5 || oy < -0.5 || oy >= 0.5) {
+                continue;
+            }
+            point2d p = {x + ox, y - band_y0 + oy};  // 밴드 좌표
+            int n = corners_push(list, p, R);
+            if (n < 0) {
+                atomic_store(&job->failed, 1);
+                break;
+            }
+            list->Score[n] = s;
+        }
+    }
+    job->band_max[b] = band_max;
+
+    unsigned char *keep = arena_alloc(a, list->Size > 0 ? list->Size : 1);
+    if (keep == NULL) {
+        atomic_store(&job->failed, 1);
+        list->Size = 0;
+    } else {
+        double min_score = job->params->detect_threshold * band_max;
+        for (int i = 0; i < list->Size; i++) {
+            keep[i] = (list->Score[i] >= min_score);
+        }
+        corners_compact(list, keep);
+    }
+    STATS_ELAPSED(&band_params, detect_ns, t_detect);
+
+    image_source src = image_source_crop(job->img, 0, band_y0, W, band_y0 + band->height);
+    polynomial_fit_blurred(&src, band, list, &band_params);
+    for (int i = 0; i < list->Size; i++) {
+        list->p[i].y += band_y0;
+    }
+    arena_release(a, mark);
+}
+
+// ✅ 계수 필터 뱅크 한 번으로 후보 검출 + 초기 위치: 임계점이 자기 픽셀 칸 [-0.5, 0.5)² 안에 떨어지는 픽셀만 코너로
+// 피팅 연산자가 고정 선형 사상이라 계수 k_t 는 dense 행 t 와의 상관, 정수 중심 피팅 한 번과 같음
+// 블러와 계수는 DENSE_HALO 행 halo 를 둔 밴드 단위로만 만들고 (전체 크기 블러/맵 없음), 뉴턴 반복도 그 밴드에서 함
+// 응답 |det| 이 최대의 detect_threshold 배 미만이면 버리고, 밴드 경계에서 겹친 코너는 중복 제거 (성공 시 0)
+int find_corners_dense(const image_source *img, Corner2 *corners, const Params *params) {
+    Params defaults;
+    dense_job job;
+    if (params == NULL) {
+        params_default(&defaults);
+        params = &defaults;
+    }
+    int order = (params->corner_type == CORNER_MONKEY_SADDLE) ? 3 : 2;
+    const fit_operator *op = get_fit_operator(R, order);
+    if (op == NULL || op->dense == NULL) {
+        return -1;
+    }
+
+    int r = op->r, size = 2 * r + 1, terms = (order == 3) ? MONKEY_BANK_TERMS : SADDLE_BANK_TERMS;
+    job.img = img;
+    job.op = op;
+    job.params = params;
+    job.block = select_response_block();
+    job.terms = terms;
+    job.num_taps = 0;
+    for (int p = 0; p < size * size; p++) {
+        if (op->mask[p] < 1e-6) {
+            continue;
+        }
+        job.tap_index[job.num_taps] = p;
+        for (int t = 0; t < terms; t++) {
+            job.weights[job.num_taps * terms + t] = op->dense[(size_t)t * size * size + p];
+        }
+        job.num_taps++;
+    }
+    job.band_rows = choose_band_rows(img->width, R, DENSE_HALO);
+    int num_bands = (img->height + job.band_rows - 1) / job.band_rows;
+    job.bands = malloc((size_t)num_bands * sizeof(Corner2));
+    job.band_max = calloc(num_bands, sizeof(double));
+    job.band_stats = (params->stats != NULL) ? calloc(num_bands, sizeof(fit_stats)) : NULL;
+    atomic_init(&job.failed, 0);
+    if (job.bands == NULL || job.band_max == NULL || (params->stats != NULL && job.band_stats == NULL)) {
+        free(job.bands);
+        free(job.band_max);
+        free(job.band_stats);
+        return -1;
+    }
+    for (int b = 0; b < num_bands; b++) {
+        corners_init(&job.bands[b]);
+    }
+
+    int status = blur_bands_fused(img, op->mask, R, params->pool, job.band_rows, DENSE_HALO, dense_band, &job);
+    if (atomic_load(&job.failed)) {
+        status = -1;
+    }
+
+    double max_score = 0.0;
+    for (int b = 0; b < num_bands; b++) {
+        max_score = (job.band_max[b] > max_score) ? job.band_max[b] : max_score;
+    }
+    double min_score = params->detect_threshold * max_score;
+    corners->Size = 0;
+    for (int b = 0; b < num_bands; b++) {
+        const Corner2 *list = &job.bands[b];
+        for (int i = 0; i < list->Size && status == 0; i++) {
+            if (list->Score[i] < min_score) {
+                continue;
+            }
+            int n = corners_push(corners, list->p[i], R);
+            if (n < 0) {
+                status = -1;
+                break;
+            }
+            corners->Score[n] = list->Score[i];
+        }
+        if (job.band_stats != NULL) {
+            fit_stats_add(params->stats, &job.band_stats[b]);
+        }
+        corners_free(&job.bands[b]);
+    }
+    free(job.bands);
+    free(job.band_max);
+    free(job.band_stats);
+
+    if (status == 0) {
+        status = remove_duplicates_counted(corners, params);
+    }
+    return status;
+}
+
+// 파이프라인 프레임 슬롯 (단계 사이를 오가며 버퍼를 재사용)
+typedef struct {
+    int index;              // 프레임 번호
+    int status;             // 0 정상, -1 읽기/처리 실패 (이후 단계는 건너뜀)
+    unsigned char *raw;     // 원본 픽셀 버퍼 (load 가 채움, 용량 raw_capacity)
+    size_t raw_capacity;
+    image_source src;       // 원본 (보통 raw 를 가리킴)
+    image_view blur;        // 반경 R 블러 결과 (크기가 같으면 재사용)
+    Corner2 corners;        // 검출 → 정제 결과
+    fit_stats stats;        // 이 프레임의 단계별 계측 (CALIB_STATS 빌드에서만 채워짐)
+} pipeline_frame;
+
+// 프레임 읽기: frame->src 를 채움 (frame->raw 재사용 가능, 성공 시 0)
+typedef int (*frame_load_fn)(void *ctx, int index, pipeline_frame *frame);
+// 프레임 완료: 프레임 순서대로 정제 단계 스레드에서 호출 (반환 후 슬롯은 재사용됨)
+typedef void (*frame_done_fn)(void *ctx, const pipeline_frame *frame);
+
+// 파이프라인 설정
+typedef struct {
+    int num_frames;
+    int depth;  // 동시에 떠 있는 프레임 슬롯 수 (<= 0 이면 단계 수)
+    frame_load_fn load;
+    void *load_ctx;
+    frame_done_fn done;
+    void *done_ctx;
+} pipeline_config;
+
+// 고정 용량 프레임 큐 (가득 차면 push, 비면 pop 이 대기)
+typedef struct {
+    pipeline_frame **items;
+    int capacity;
+    int head;
+    int count;
+    int closed;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} frame_queue;
+
+// ✅ 큐 생성 (성공 시 0)
+static int frame_queue_init(frame_queue *q, int capacity) {
+    q->items = malloc(capacity * sizeof(pipeline_frame *));
+    if (q->items == NULL) {
+        return -1;
+    }
+    q->capacity = capacity;
+    q->head = q->count = q->closed = 0;
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    return 0;
+}
+
+// ✅ 큐 해제
+static void frame_queue_destroy(frame_queue *q) {
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q->items);
+}
+
+// ✅ 프레임 넣기 (자리가 날 때까지 대기)
+static void frame_queue_push(frame_queue *q, pipeline_frame *f) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->capacity) {
+        pthread_cond_wait(&q->not_full, &q->lock);
+    }
+    q->items[(q->head + q->count) % q->capacity] = f;
+    q->count++;
+    pthread_cond_signal(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+// ✅ 프레임 꺼내기 (닫히고 비었으면 NULL)
+static pipeline_frame *frame_queue_pop(frame_queue *q) {
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0 && !q->closed) {
+        pthread_cond_wait(&q->not_empty, &q->lock);
+    }
+    pipeline_frame *f = NULL;
+    if (q->count > 0) {
+        f = q->items[q->head];
+        q->head = (q->head + 1) % q->capacity;
+        q->count--;
+        pthread_cond_signal(&q->not_full);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return f;
+}
+
+// ✅ 더 넣을 프레임이 없음을 알림
+static void frame_queue_close(frame_queue *q) {
+    pthread_mutex_lock(&q->lock);
+    q->closed = 1;
+    pthread_cond_broadcast(&q->not_empty);
+    pthread_mutex_unlock(&q->lock);
+}
+
+// 파이프라인 단계: free → load → blur → detect → refine → free
+enum { STAGE_LOAD, STAGE_BLUR, STAGE_DETECT, STAGE_REFINE, NUM_STAGES };
+
+// 파이프라인 실행 컨텍스트
+typedef struct {
+    const pipeline_config *cfg;
+    Params params;                      // 단계 스레드마다 단일 스레드로 실행 (pool 없음)
+    frame_queue free_slots;
+    frame_queue queues[NUM_STAGES];     // queues[s]: 단계 s 가 꺼내 가는 큐
+} pipeline;
+
+// ✅ 읽기 단계: 빈 슬롯을 받아 다음 프레임을 채움
+static void *pipeline_load_main(void *arg) {
+    pipeline *pl = arg;
+    for (int i = 0; i < pl->cfg->num_frames; i++) {
+        pipeline_frame *f = frame_queue_pop(&pl->free_slots);
+        f->index = i;
+        fit_stats_reset(&f->stats);
+        f->status = pl->cfg->load(pl->cfg->load_ctx, i, f);
+        frame_queue_push(&pl->queues[STAGE_BLUR], f);
+    }
+    frame_queue_close(&pl->queues[STAGE_BLUR]);
+    return NULL;
+}
+
+// ✅ 단계 스레드용 파라미터: 계측은 프레임 슬롯에 기록 (단계끼리 카운터를 공유하지 않음)
+static Params pipeline_frame_params(const pipeline *pl, pipeline_frame *f) {
+    Params params = pl->params;
+    params.stats = &f->stats;
+    return params;
+}
+
+// ✅ 블러 단계: 반경 R 원뿔 블러 (슬롯의 블러 버퍼는 크기가 바뀔 때만 다시 할당)
+static void *pipeline_blur_main(void *arg) {
+    pipeline *pl = arg;
+    const fit_operator *op = get_fit_operator(R, 2);
+    pipeline_frame *f;
+    while ((f = frame_queue_pop(&pl->queues[STAGE_BLUR])) != NULL) {
+        Params params = pipeline_frame_params(pl, f);
+        if (f->status == 0 && (f->blur.width != f->src.width || f->blur.height != f->src.height)) {
+            image_destroy(&f->blur);
+            f->status = image_create(&f->blur, f->src.width, f->src.height);
+        }
+        if (f->status == 0) {
+            STATS_CLOCK(t_blur);
+            f->status = (op != NULL) ? apply_blur(&f->src, op->mask, R, &params, &f->blur) : -1;
+            STATS_ELAPSED(&params, blur_ns, t_blur);
+        }
+        frame_queue_push(&pl->queues[STAGE_DETECT], f);
+    }
+    frame_queue_close(&pl->queues[STAGE_DETECT]);
+    return NULL;
+}
+
+// ✅ 검출 단계: 블러 이미지에서 후보 검출 (피라미드 설정 시 원본에서 거친 단계 검출)
+static void *pipeline_detect_main(void *arg) {
+    pipeline *pl = arg;
+    pipeline_frame *f;
+    while ((f = frame_queue_pop(&pl->queues[STAGE_DETECT])) != NULL) {
+        Params params = pipeline_frame_params(pl, f);
+        if (f->status == 0) {
+            STATS_CLOCK(t_detect);
+            f->status = (params.pyramid_levels > 0)
+                      ? detect_candidates_pyramid(&f->src, &f->corners, &params)
+                      : detect_candidates_blurred(&f->blur, &f->corners, &params);
+            STATS_ELAPSED(&params, detect_ns, t_detect);
+        }
+        frame_queue_push(&pl->queues[STAGE_REFINE], f);
+    }
+    frame_queue_close(&pl->queues[STAGE_REFINE]);
+    return NULL;
+}
+
+// ✅ 정제 단계 (호출 스레드): 다항식 피팅 → 완료 콜백 → 슬롯 반납
+static void pipeline_refine_loop(pipeline *pl) {
+    pipeline_frame *f;
+    while ((f = frame_queue_pop(&pl->queues[STAGE_REFINE])) != NULL) {
+        Params params = pipeline_frame_params(pl, f);
+        if (f->status == 0) {
+            polynomial_fit_blurred(&f->src, &f->blur, &f->corners, &params);
+            f->status = remove_duplicates_counted(&f->corners, &params);
+        }
+        if (f->status != 0) {
+            f->corners.Size = 0;
         }
+        if (pl->cfg->done != NULL) {
+            pl->cfg->done(pl->cfg->done_ctx, f);
+        }
+        frame_queue_push(&pl->free_slots, f);
+    }
+}
 
-        double dx = (k[2] * k[4] - 2 * k[1] * k[3]) / det;
-        double dy = (k[2] * k[3] - 2 * k[0] * k[4]) / det;
+// ✅ 프레임 스트림 처리: 읽기/블러/검출/정제를 각 스레드에서 겹쳐 실행 (성공 시 0)
+// 슬롯 depth 개를 돌려 쓰므로 메모리는 프레임 수와 무관, 처리량은 가장 느린 단계에 수렴
+// params->pool 은 사용하지 않음 (단계끼리 풀을 공유하면 작업이 섞임)
+int run_frame_pipeline(const pipeline_config *cfg, const Params *params) {
+    pipeline pl;
+    pthread_t threads[STAGE_DETECT + 1];
+    void *(*stage_main[STAGE_DETECT + 1])(void *) = {pipeline_load_main, pipeline_blur_main, pipeline_detect_main};
+    int depth = (cfg->depth > 0) ? cfg->depth : NUM_STAGES;
+    int num_queues = 0, status = 0;
 
-        u_cur += dx;
-        v_cur += dy;
+    pl.cfg = cfg;
+    if (params != NULL) {
+        pl.params = *params;
+    } else {
+        params_default(&pl.params);
+    }
+    pl.params.pool = NULL;
 
-        if (sqrt(dx * dx + dy * dy) <= 0.01) {
+    pipeline_frame *slots = calloc(depth, sizeof(pipeline_frame));
+    if (slots == NULL || frame_queue_init(&pl.free_slots, depth) != 0) {
+        free(slots);
+        return -1;
+    }
+    for (; num_queues < NUM_STAGES; num_queues++) {
+        if (frame_queue_init(&pl.queues[num_queues], depth) != 0) {
+            status = -1;
             break;
         }
+    }
+    for (int i = 0; i < depth; i++) {
+        corners_init(&slots[i].corners);
+        frame_queue_push(&pl.free_slots, &slots[i]);
+    }
 
-        if (is_saddle_point) {
-            choose[i] = 1;
-            corners_out.p[corners_out.Size] = corners->p[i];
-            corners_out.Size++;
+    // 뒤 단계부터 시작: 시작에 실패하면 그 단계의 출력 큐만 닫으면 이미 도는 뒤 단계가 차례로 끝남
+    int first = STAGE_REFINE;
+    if (status == 0) {
+        while (first > STAGE_LOAD) {
+            if (pthread_create(&threads[first - 1], NULL, stage_main[first - 1], &pl) != 0) {
+                status = -1;
+                break;
+            }
+            first--;
+        }
+        if (first > STAGE_LOAD) {
+            frame_queue_close(&pl.queues[first]);
+        }
+        pipeline_refine_loop(&pl);
+        for (int t = first; t <= STAGE_DETECT; t++) {
+            pthread_join(threads[t], NULL);
         }
     }
 
-    *corners = corners_out;
+    for (int i = 0; i < depth; i++) {
+        free(slots[i].raw);
+        image_destroy(&slots[i].blur);
+        corners_free(&slots[i].corners);
+    }
+    for (int q = 0; q < num_queues; q++) {
+        frame_queue_destroy(&pl.queues[q]);
+    }
+    frame_queue_destroy(&pl.free_slots);
+    free(slots);
+    return status;
+}
+
+// ✅ 파일 경로 배열(ctx: const char **)에서 PGM 을 슬롯 버퍼로 읽는 기본 load 함수
+int pipeline_load_pgm(void *ctx, int index, pipeline_frame *frame) {
+    const char *const *paths = ctx;
+    return image_load_pgm_into(paths[index], &frame->raw, &frame->raw_capacity, &frame->src);
 }
 
 // 🛠 기존 212줄 코드 유지!
 
-int main() {
-    double img[HEIGHT][WIDTH] = {0};
+// bench.c 처럼 이 파일을 #include 해서 쓰는 프로그램은 CALIB_NO_MAIN 을 정의
+#ifndef CALIB_NO_MAIN
+// ✅ 여러 장 모드의 프레임 완료 콜백: 파일마다 코너 목록 출력 (ctx: 경로 배열)
+static void main_print_frame(void *ctx, const pipeline_frame *frame) {
+    const char *const *paths = ctx;
+    if (frame->status != 0) {
+        fprintf(stderr, "cannot load image: %s\n", paths[frame->index]);
+        return;
+    }
+    printf("%s: %d corners\n", paths[frame->index], frame->corners.Size);
+    for (int i = 0; i < frame->corners.Size; i++) {
+        printf("%.3f %.3f\n", frame->corners.p[i].x, frame->corners.p[i].y);
+    }
+#ifdef CALIB_STATS
+    fit_stats_write_json(&frame->stats, stderr);
+#endif
+}
+
+int main(int argc, char **argv) {
+    image_source img;
     Corner2 corners;
-    corners.Size = 0;
+    Params params;
+    corners_init(&corners);
+    params_default(&params);
 
-    polynomial_fit_saddle(img, &corners);
+    // 이미지 여러 장: 읽기/블러/검출/정제를 프레임 파이프라인으로 겹쳐 처리
+    if (argc > 2) {
+        pipeline_config cfg = {argc - 1, 0, pipeline_load_pgm, argv + 1, main_print_frame, argv + 1};
+        return run_frame_pipeline(&cfg, &params) == 0 ? 0 : 1;
+    }
+
+    if (argc > 1) {
+        if (image_load_pgm_raw(argv[1], &img) != 0) {
+            fprintf(stderr, "cannot load image: %s\n", argv[1]);
+            return 1;
+        }
+    } else {
+        uint8_t *blank = calloc(100 * 100, 1);
+        if (blank == NULL) {
+            return 1;
+        }
+        img = image_source_u8(blank, 100, 100, 100);
+    }
+
+    params.pool = thread_pool_create(0);
+    fit_stats stats;
+    fit_stats_reset(&stats);
+    params.stats = &stats;
+    if (find_corners_source(&img, &corners, &params) == 0) {
+        printf("%d corners\n", corners.Size);
+        for (int i = 0; i < corners.Size; i++) {
+            printf("%.3f %.3f\n", corners.p[i].x, corners.p[i].y);
+        }
+#ifdef CALIB_STATS
+        fit_stats_write_json(&stats, stderr);
+#endif
+    }
+    thread_pool_destroy(params.pool);
+    corners_free(&corners);
+    free((void *)img.data);
     return 0;
 }
+#endif
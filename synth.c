@@ -0,0 +1,241 @@
+// 합성 캘리브레이션 타깃 (체커보드 / deltille) 과 정답 코너
+// final.c 다음에 #include 해서 사용 (bench.c, accuracy.c)
+// 픽셀 (x, y) 는 [x - 0.5, x + 0.5] x [y - 0.5, y + 0.5] 영역, 정답 코너도 같은 좌표계
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+#ifndef M_SQRT1_2
+#define M_SQRT1_2 0.70710678118654752440
+#endif
+
+// 합성 타깃 종류
+typedef enum {
+    SYNTH_CHECKERBOARD,  // 안장점 코너 (2차 피팅)
+    SYNTH_DELTILLE       // 삼각 격자, monkey saddle 코너 (3차 피팅)
+} synth_pattern;
+
+// 합성 타깃 설정
+typedef struct {
+    synth_pattern pattern;
+    double x0, y0;        // 기준 코너 위치 (소수 픽셀 가능)
+    double size;          // 칸 크기 (deltille 은 평행선 간격)
+    double angle;         // 회전 (라디안)
+    double dark, bright;  // 두 색의 밝기
+    int supersample;      // 픽셀당 축별 샘플 수 (안티앨리어싱)
+    double blur_sigma;    // 렌더 후 가우시안 블러 (0 이면 없음)
+    double noise_sigma;   // 가산 가우시안 잡음 표준편차 (밝기 단위)
+    int quantize;         // 1 이면 0..255 정수로 반올림 (8비트 카메라 흉내)
+    unsigned seed;        // 잡음 난수 시드
+} synth_config;
+
+// ✅ 기본 설정 (640x480 중앙 기준 체커보드, 블러/잡음 없음)
+void synth_config_default(synth_config *cfg) {
+    cfg->pattern = SYNTH_CHECKERBOARD;
+    cfg->x0 = 320.0;
+    cfg->y0 = 240.0;
+    cfg->size = 40.0;
+    cfg->angle = 0.0;
+    cfg->dark = 30.0;
+    cfg->bright = 220.0;
+    cfg->supersample = 16;
+    cfg->blur_sigma = 0.0;
+    cfg->noise_sigma = 0.0;
+    cfg->quantize = 0;
+    cfg->seed = 1;
+}
+
+// 경계선 묶음 (법선 n, 간격 size) — 체커보드는 2개, deltille 은 3개
+typedef struct {
+    int count;
+    double nx[3], ny[3];
+} synth_lines;
+
+// ✅ 설정의 경계선 법선을 계산
+static void synth_lines_init(const synth_config *cfg, synth_lines *l) {
+    if (cfg->pattern == SYNTH_DELTILLE) {
+        // 60도씩 돌린 세 평행선 묶음
+        l->count = 3;
+        for (int k = 0; k < 3; k++) {
+            double th = cfg->angle + M_PI / 2 + k * M_PI / 3;
+            l->nx[k] = cos(th);
+            l->ny[k] = sin(th);
+        }
+    } else {
+        l->count = 2;
+        l->nx[0] = cos(cfg->angle);
+        l->ny[0] = sin(cfg->angle);
+        l->nx[1] = -sin(cfg->angle);
+        l->ny[1] = cos(cfg->angle);
+    }
+}
+
+// ✅ 기준 코너에 대한 상대 위치 (px, py) 가 어두운 칸이면 1 (지나온 선 수의 홀짝)
+static int synth_is_dark(const synth_lines *l, double size, double px, double py) {
+    int parity = 0;
+    for (int k = 0; k < l->count; k++) {
+        parity += (int)floor((px * l->nx[k] + py * l->ny[k]) / size);
+    }
+    return parity & 1;
+}
+
+// ✅ 중심 (px, py) 인 픽셀 안으로 경계선이 지나가면 1 (외접원 기준)
+static int synth_near_edge(const synth_lines *l, double size, double px, double py) {
+    for (int k = 0; k < l->count; k++) {
+        double d = (px * l->nx[k] + py * l->ny[k]) / size, h = M_SQRT1_2 / size;
+        if (floor(d - h) != floor(d + h)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// ✅ xorshift32 난수
+static unsigned synth_rand(unsigned *state) {
+    unsigned x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// ✅ 표준 정규분포 난수 (Box-Muller)
+static double synth_gauss(unsigned *state) {
+    double u1 = (synth_rand(state) + 1.0) / 4294967297.0;
+    double u2 = (synth_rand(state) + 1.0) / 4294967297.0;
+    return sqrt(-2.0 * log(u1)) * cos(2 * M_PI * u2);
+}
+
+// ✅ 분리형 가우시안 블러 (가장자리는 복제, 성공 시 0)
+static int synth_blur(image_view *img, double sigma) {
+    int r = (int)ceil(3 * sigma);
+    double k[64];
+    double *line = malloc((size_t)(img->width > img->height ? img->width : img->height) * sizeof(double));
+    if (r > 31) {
+        r = 31;
+    }
+    if (line == NULL) {
+        return -1;
+    }
+    double sum = 0;
+    for (int i = -r; i <= r; i++) {
+        k[i + r] = exp(-0.5 * i * i / (sigma * sigma));
+        sum += k[i + r];
+    }
+    for (int i = 0; i <= 2 * r; i++) {
+        k[i] /= sum;
+    }
+
+    for (int y = 0; y < img->height; y++) {
+        for (int x = 0; x < img->width; x++) {
+            line[x] = PIXEL(img, x, y);
+        }
+        for (int x = 0; x < img->width; x++) {
+            double acc = 0;
+            for (int i = -r; i <= r; i++) {
+                int xx = x + i < 0 ? 0 : (x + i >= img->width ? img->width - 1 : x + i);
+                acc += k[i + r] * line[xx];
+            }
+            PIXEL(img, x, y) = acc;
+        }
+    }
+    for (int x = 0; x < img->width; x++) {
+        for (int y = 0; y < img->height; y++) {
+            line[y] = PIXEL(img, x, y);
+        }
+        for (int y = 0; y < img->height; y++) {
+            double acc = 0;
+            for (int i = -r; i <= r; i++) {
+                int yy = y + i < 0 ? 0 : (y + i >= img->height ? img->height - 1 : y + i);
+                acc += k[i + r] * line[yy];
+            }
+            PIXEL(img, x, y) = acc;
+        }
+    }
+    free(line);
+    return 0;
+}
+
+// ✅ 타깃 렌더링 (img 는 미리 할당, 성공 시 0)
+// 픽셀마다 supersample² 점의 면적 평균 → 블러 → 잡음 → 양자화 순서
+// 경계선이 지나지 않는 픽셀은 한 색이므로 중심 한 점만 봄
+int synth_render(const synth_config *cfg, image_view *img) {
+    int S = cfg->supersample > 0 ? cfg->supersample : 1;
+    unsigned state = cfg->seed ? cfg->seed : 1;
+    synth_lines lines;
+    synth_lines_init(cfg, &lines);
+
+    for (int y = 0; y < img->height; y++) {
+        for (int x = 0; x < img->width; x++) {
+            double cx = x - cfg->x0, cy = y - cfg->y0;
+            double a;
+            if (!synth_near_edge(&lines, cfg->size, cx, cy)) {
+                a = synth_is_dark(&lines, cfg->size, cx, cy);
+            } else {
+                int dark = 0;
+                for (int sy = 0; sy < S; sy++) {
+                    for (int sx = 0; sx < S; sx++) {
+                        dark += synth_is_dark(&lines, cfg->size, cx + (sx + 0.5) / S - 0.5, cy + (sy + 0.5) / S - 0.5);
+                    }
+                }
+                a = (double)dark / (S * S);
+            }
+            PIXEL(img, x, y) = a * cfg->dark + (1 - a) * cfg->bright;
+        }
+    }
+
+    if (cfg->blur_sigma > 0 && synth_blur(img, cfg->blur_sigma) != 0) {
+        return -1;
+    }
+    for (int y = 0; y < img->height; y++) {
+        for (int x = 0; x < img->width; x++) {
+            double v = PIXEL(img, x, y);
+            if (cfg->noise_sigma > 0) {
+                v += cfg->noise_sigma * synth_gauss(&state);
+            }
+            if (cfg->quantize) {
+                v = floor(v + 0.5);
+                v = v < 0 ? 0 : (v > 255 ? 255 : v);
+            }
+            PIXEL(img, x, y) = v;
+        }
+    }
+    return 0;
+}
+
+// ✅ 이미지 가장자리에서 margin 이상 떨어진 정답 코너를 truth 에 채움 (코너 수 반환, 실패 시 -1)
+// 체커보드: 두 칸 경계선의 교점, deltille: 세 평행선 묶음이 모두 지나는 격자점
+int synth_ground_truth(const synth_config *cfg, int width, int height, int margin, Corner2 *truth) {
+    double c = cos(cfg->angle), s = sin(cfg->angle);
+    double ax, ay, bx, by;  // 격자 기저 (픽셀)
+    if (cfg->pattern == SYNTH_DELTILLE) {
+        // 처음 두 묶음의 법선 n0, n1 에 대해 n0·p = i·size, n1·p = j·size 인 점
+        // (n0 - n1 + n2 = 0 이라 세 번째 묶음도 항상 지남)
+        double t0 = cfg->angle + M_PI / 2, t1 = t0 + M_PI / 3;
+        double det = cos(t0) * sin(t1) - sin(t0) * cos(t1);
+        ax = cfg->size * sin(t1) / det;
+        ay = -cfg->size * cos(t1) / det;
+        bx = -cfg->size * sin(t0) / det;
+        by = cfg->size * cos(t0) / det;
+    } else {
+        ax = cfg->size * c;
+        ay = cfg->size * s;
+        bx = -cfg->size * s;
+        by = cfg->size * c;
+    }
+
+    int extent = (int)ceil((width + height) / (cfg->size * 0.5)) + 1;
+    truth->Size = 0;
+    for (int j = -extent; j <= extent; j++) {
+        for (int i = -extent; i <= extent; i++) {
+            point2d p = {cfg->x0 + i * ax + j * bx, cfg->y0 + i * ay + j * by};
+            if (p.x < margin || p.x >= width - margin || p.y < margin || p.y >= height - margin) {
+                continue;
+            }
+            if (corners_push(truth, p, R) < 0) {
+                return -1;
+            }
+        }
+    }
+    return truth->Size;
+}